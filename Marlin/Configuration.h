@@ -75,6 +75,31 @@
 // and processor overload (too many expensive sqrt calls).
 #define DELTA_SEGMENTS_PER_SECOND 160
 
+// Solve the segments of a move incrementally instead of calling calculate_delta() for each one.
+// The term under each tower's sqrt is stepped by forward differences and the root is refined
+// by one Newton step from the previous segments, falling back to sqrt() when the refinement
+// could be off by more than DELTA_INCREMENTAL_TOLERANCE. The first and last segment of every
+// move and every DELTA_INCREMENTAL_RESYNC'th segment are solved exactly to stop any drift.
+//#define DELTA_INCREMENTAL_KINEMATICS
+#ifdef DELTA_INCREMENTAL_KINEMATICS
+  #define DELTA_INCREMENTAL_TOLERANCE 0.001 // mm
+  #define DELTA_INCREMENTAL_RESYNC 16       // segments
+#endif
+
+// Choose the number of segments of a move from the curvature of the carriage paths instead of
+// from its duration alone. Each move gets just enough segments to keep every carriage within
+// DELTA_SEGMENT_MAX_ERROR of its true path; DELTA_SEGMENTS_PER_SECOND (M665 S) becomes the cap.
+//#define DELTA_ADAPTIVE_SEGMENTS
+#ifdef DELTA_ADAPTIVE_SEGMENTS
+  #define DELTA_SEGMENT_MAX_ERROR 0.01 // mm
+#endif
+
+// Compute the carriage positions of each segment in fixed point (steps with 8 fractional bits)
+// with an integer square root, and hand them to the planner as steps. Within one step of the
+// float path; falls back to it if a diagonal rod is 65000 steps or longer.
+// Replaces DELTA_INCREMENTAL_KINEMATICS. With ENABLE_AUTO_BED_LEVELING it needs NONLINEAR_BED_LEVELING.
+//#define DELTA_FIXED_POINT_KINEMATICS
+
 // Center-to-center distance of the holes in the diagonal push rods.
 #define DEFAULT_DELTA_DIAGONAL_ROD 300.0 // mm
 
@@ -438,7 +463,31 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 
 #define ENABLE_AUTO_BED_LEVELING // Delete the comment to enable (remove // at the start of the line)
 #define Z_PROBE_REPEATABILITY_TEST  // If not commented out, Z-Probe Repeatability test will be included if Auto Bed Leveling is Enabled.
-#define PROBE_AVG 3 // If defined it needs to be a number that will be the number of samples when probing Z that are taken and averaged.n
+#define M48_MAX_SAMPLES 1000          // M48 keeps running statistics, so this only bounds the run time
+#define M48_HISTOGRAM_BINS 11         // M48 histogram, centred on the first sample
+#define M48_HISTOGRAM_BIN_WIDTH 0.005 // mm
+// Instead of a fixed 500ms wait for the FSR to recover after each M48 sample, watch Z_MIN and go
+// on once it has read released for PROBE_SETTLE_WINDOW ms (PROBE_SETTLE_TIMEOUT ms at most).
+// G29/G30 wait the same way after each lift between taps; PROBE_LOG records the longest wait.
+//#define PROBE_SETTLE_MONITOR
+#define PROBE_SETTLE_WINDOW 20 // ms
+#define PROBE_SETTLE_TIMEOUT 500 // ms
+// Place the probe trigger between motor steps: an interrupt on Z_MIN_PIN records the step counts
+// and Timer1 the moment the probe fires, and the trigger is interpolated across the step interval.
+// PROBE_TRIGGER_INTERRUPT is the attachInterrupt() number of Z_MIN_PIN (5 = D18 on a Mega/RAMPS).
+//#define PROBE_TRIGGER_INTERPOLATION
+#define PROBE_TRIGGER_INTERRUPT 5
+// Adaptive sampling (instead of PROBE_AVG): keep tapping until the 95% confidence interval of the
+// mean is within PROBE_ADAPTIVE_TOLERANCE, using PROBE_ADAPTIVE_MIN..MAX taps. Taps further than
+// PROBE_ADAPTIVE_MAD_LIMIT median absolute deviations from the median are ignored.
+//#define PROBE_ADAPTIVE
+#define PROBE_ADAPTIVE_MIN 3
+#define PROBE_ADAPTIVE_MAX 10
+#define PROBE_ADAPTIVE_TOLERANCE 0.01 // mm
+#define PROBE_ADAPTIVE_MAD_LIMIT 3.5
+#ifndef PROBE_ADAPTIVE
+  #define PROBE_AVG 3 // If defined it needs to be a number that will be the number of samples when probing Z that are taken and averaged.n
+#endif
 
 #ifdef ENABLE_AUTO_BED_LEVELING
 
@@ -470,6 +519,10 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 
     // probe at the points of a lattice grid
     #define AUTO_BED_LEVELING_GRID_POINTS 7
+
+    // Probe the G29 grid (and the G30 L point set) along a short tour planned once from the bed
+    // centre (nearest neighbour, then 2-opt) instead of a serpentine over the rows.
+    //#define PROBE_TOUR
     #define AUTO_BED_LEVELING_GRID_X ((RIGHT_PROBE_BED_POSITION - LEFT_PROBE_BED_POSITION) / (AUTO_BED_LEVELING_GRID_POINTS - 1))
     #define AUTO_BED_LEVELING_GRID_Y ((BACK_PROBE_BED_POSITION - FRONT_PROBE_BED_POSITION) / (AUTO_BED_LEVELING_GRID_POINTS - 1))
 
@@ -479,6 +532,34 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
     // Works best with AUTO_BED_LEVELING_GRID_POINTS 5 or higher.
     #define NONLINEAR_BED_LEVELING
 
+    // Compensate from a finer mesh built out of the probed grid with bicubic (Catmull-Rom)
+    // interpolation, so a warped bed is followed smoothly instead of in flat facets. Probing
+    // is unchanged. G29 S<n> splits each probed cell n x n, as far as the RAM budget allows.
+    //#define BED_LEVEL_SUBDIVISION
+    #ifdef BED_LEVEL_SUBDIVISION
+      #define BED_LEVEL_SUBDIVISION_DEFAULT 3
+      #define BED_LEVEL_MESH_MAX_POINTS 19 // per side; the mesh takes 4*19*19 = 1444 bytes of RAM
+    #endif
+
+    // Two-pass G29: probe every other row and column around the centre, fit a plane, then probe
+    // in full only the 2x2-cell blocks whose corners leave the plane by more than
+    // BED_LEVEL_ADAPTIVE_TOLERANCE or whose residual changes faster than BED_LEVEL_ADAPTIVE_SLOPE.
+    // The other blocks are interpolated from their corners. Needs an odd grid, not BED_LEVEL_POLAR.
+    //#define BED_LEVEL_ADAPTIVE
+    #ifdef BED_LEVEL_ADAPTIVE
+      #define BED_LEVEL_ADAPTIVE_TOLERANCE 0.02 // mm
+      #define BED_LEVEL_ADAPTIVE_SLOPE 0.001    // mm per mm
+    #endif
+
+    // Probe and compensate on a polar mesh for round delta beds: the centre plus
+    // BED_LEVEL_POLAR_RINGS rings of BED_LEVEL_POLAR_SPOKES points out to DELTA_PROBABLE_RADIUS.
+    // Every point is reachable, so nothing is extrapolated. Not with BED_LEVEL_SUBDIVISION.
+    //#define BED_LEVEL_POLAR
+    #ifdef BED_LEVEL_POLAR
+      #define BED_LEVEL_POLAR_RINGS 3
+      #define BED_LEVEL_POLAR_SPOKES 12
+    #endif
+
     // Up to 3 sets of coordinates for deploying and retracting the spring loaded touch probe on G29,
     // if servo actuated touch probe is not defined. Uncomment as appropriate for your printer/probe.
 
@@ -572,12 +653,44 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
   #define AUTOCAL_TRAVELRATE XY_TRAVEL_SPEED/60 //150 //200 // **PJR - convert to since in mm/sec
   #define AUTOCAL_PROBERATE 10 // mm/sec
 
+  // Two-speed probing: probe_pt() and M48 find the bed once at PROBE_FAST_FEEDRATE, then take
+  // every sample as a slow re-tap (AUTOCAL_PROBERATE) from PROBE_RETAP_BACKOFF above the surface.
+  // Change with M377 F<fast> S<slow> B<backoff>, store with M500.
+  //#define PROBE_TWO_SPEED
+  #define PROBE_FAST_FEEDRATE 25 // mm/sec
+  #define PROBE_RETAP_BACKOFF 1.5 // mm
+
+  // Fly-by probing (with PROBE_TWO_SPEED): between points of one G29/G30 the nozzle stays
+  // PROBE_FLYBY_CLEARANCE above the last probed height, plus the steepest slope seen so far times
+  // the hop length, and the lift, travel and fast approach are queued as one stream of moves.
+  // A touch on the way stops the stream there; the probe then lifts fully and travels again.
+  //#define PROBE_FLYBY
+  #define PROBE_FLYBY_CLEARANCE 1.0 // mm
+
+  // Pipeline G30: queue the travel to the next point right after each trigger, so the point
+  // reports, calibration_report() and the adjustment bookkeeping run while the carriages move.
+  //#define AUTOCAL_PIPELINE
+
+  // Keep G29/G30 probe readings in a RAM ring of PROBE_LOG_SIZE records (17 bytes each, 19 with
+  // PROBE_SETTLE_MONITOR) instead of printing every point, so probing does not wait on the serial
+  // port. G29/G30 end with a summary line; M378 dumps the log as CSV and M378 C clears it.
+  //#define PROBE_LOG
+  #define PROBE_LOG_SIZE 32
+
   //Amount to lift head after probing a point
   #define AUTOCAL_PROBELIFT Z_RAISE_BETWEEN_PROBINGS //3 //2 // mm
 
   // Precision for G30 delta autocalibration function (calibrate to within +/- this value)
   #define AUTOCALIBRATION_PRECISION 0.05// mm
 
+  // G30 L<factors> probes DELTA_CALIBRATION_POINTS points once and fits the geometry to them by
+  // least squares (Gauss-Newton) instead of the iterative G30 A/E adjustments. Factors are:
+  // 3 = endstop offsets, 4 = + delta radius, 6 = + tower A/B angles (default), 7 = + diagonal rod.
+  // G30 L P<passes> re-probes after each fit until within AUTOCALIBRATION_PRECISION (default 2 passes).
+  //#define DELTA_LEAST_SQUARES_CALIBRATION
+  #define DELTA_CALIBRATION_POINTS 13 // centre, 6 at bed_radius and 6 at half radius
+  #define DELTA_CALIBRATION_ITERATIONS 3 // Gauss-Newton steps per probe pass
+
   //#define Z_PROBE_SLED // turn on if you have a z-probe mounted on a sled like those designed by Charles Bell
   //#define SLED_DOCKING_OFFSET 5 // the extra distance the X axis must travel to pickup the sled. 0 should be fine but you can push it further if you'd like.
 
@@ -660,6 +773,10 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 //to disable EEPROM Serial responses and decrease program space by ~1700 byte: comment this out:
 // please keep turned on if you can.
 #define EEPROM_CHITCHAT
+// Keep the NONLINEAR_BED_LEVELING mesh in EEPROM and load it at boot, so G29 is not needed after
+// every power cycle. M374 saves, M375 loads, M376 reports. G28 then keeps the mesh; G29 and G30
+// still start from a cleared one.
+//#define BED_LEVEL_EEPROM
 
 // Preheat Constants
 #define PLA_PREHEAT_HOTEND_TEMP 180
@@ -929,4 +1046,4 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 #include "Configuration_adv.h"
 #include "thermistortables.h"
 
-#endif //__CONFIGURATION_H
+#endif //__CONFIGURATION_H
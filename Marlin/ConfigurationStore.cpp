@@ -31,6 +31,20 @@ void _EEPROM_readData(int &pos, uint8_t* value, uint8_t size)
 
 #define EEPROM_OFFSET 100
 
+#ifdef BED_LEVEL_EEPROM
+// The settings must end before the stored mesh starts (checked when storing them),
+// and the mesh must end within the EEPROM
+#define EEPROM_MESH_OFFSET 1024
+#ifdef BED_LEVEL_POLAR
+  #define EEPROM_MESH_SIZE (4 + 3 + 4 * (1 + BED_LEVEL_POLAR_RINGS * BED_LEVEL_POLAR_SPOKES) + 1 + 2)
+#else
+  #define EEPROM_MESH_SIZE (4 + 3 + 4 * AUTO_BED_LEVELING_GRID_POINTS * AUTO_BED_LEVELING_GRID_POINTS + 1 + 2)
+#endif
+#if EEPROM_MESH_OFFSET + EEPROM_MESH_SIZE > E2END + 1
+  #error "The BED_LEVEL_EEPROM mesh does not fit in this processor's EEPROM, use fewer bed_level points"
+#endif
+#endif
+
 
 // IMPORTANT:  Whenever there are changes made to the variables stored in EEPROM
 // in the functions below, also increment the version number. This makes sure that
@@ -47,6 +61,10 @@ void _EEPROM_readData(int &pos, uint8_t* value, uint8_t size)
 	#undef EEPROM_VERSION
 	#define EEPROM_VERSION "V18"
 #endif
+#ifdef PROBE_TWO_SPEED
+	#undef EEPROM_VERSION
+	#define EEPROM_VERSION "V19"
+#endif
 
 #ifdef EEPROM_SETTINGS
 void Config_StoreSettings() 
@@ -76,6 +94,11 @@ void Config_StoreSettings()
   EEPROM_WRITE_VAR(i,diagrod_adj);
   EEPROM_WRITE_VAR(i,z_probe_offset);
   #endif
+  #ifdef PROBE_TWO_SPEED
+  EEPROM_WRITE_VAR(i,probe_fast_feedrate);
+  EEPROM_WRITE_VAR(i,probe_slow_feedrate);
+  EEPROM_WRITE_VAR(i,probe_retap_backoff);
+  #endif
   #ifndef ULTIPANEL
   int plaPreheatHotendTemp = PLA_PREHEAT_HOTEND_TEMP, plaPreheatHPBTemp = PLA_PREHEAT_HPB_TEMP, plaPreheatFanSpeed = PLA_PREHEAT_FAN_SPEED;
   int absPreheatHotendTemp = ABS_PREHEAT_HOTEND_TEMP, absPreheatHPBTemp = ABS_PREHEAT_HPB_TEMP, absPreheatFanSpeed = ABS_PREHEAT_FAN_SPEED;
@@ -105,6 +128,14 @@ void Config_StoreSettings()
   #ifdef SCARA
   EEPROM_WRITE_VAR(i,axis_scaling);        // Add scaling for SCARA
   #endif
+  #ifdef BED_LEVEL_EEPROM
+  if (i > EEPROM_MESH_OFFSET)
+  {
+    // Written over the start of the stored mesh, which no longer loads
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("Settings overrun the stored mesh, move EEPROM_MESH_OFFSET");
+  }
+  #endif
   char ver2[4]=EEPROM_VERSION;
   i=EEPROM_OFFSET;
   EEPROM_WRITE_VAR(i,ver2); // validate data
@@ -113,6 +144,114 @@ void Config_StoreSettings()
 }
 #endif //EEPROM_SETTINGS
 
+#ifdef BED_LEVEL_EEPROM
+// The bed_level mesh is stored apart from the settings, so either can change
+// without invalidating the other:
+//   version, layout (polar flag, rows, columns), heights, subdivision, CRC-16
+#define EEPROM_MESH_VERSION "M01"
+
+#ifdef BED_LEVEL_POLAR
+  #define EEPROM_MESH_LAYOUT { 1, BED_LEVEL_POLAR_RINGS, BED_LEVEL_POLAR_SPOKES }
+#else
+  #define EEPROM_MESH_LAYOUT { 0, AUTO_BED_LEVELING_GRID_POINTS, AUTO_BED_LEVELING_GRID_POINTS }
+#endif
+
+// CRC-16/CCITT of the EEPROM bytes from pos up to end
+static uint16_t eeprom_crc(int pos, int end)
+{
+  uint16_t crc = 0xFFFF;
+  for (; pos < end; pos++)
+  {
+    crc ^= uint16_t(eeprom_read_byte((unsigned char*)pos)) << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+void Config_StoreMesh()
+{
+  char ver[4]= "000";
+  uint8_t layout[3] = EEPROM_MESH_LAYOUT;
+  #ifdef BED_LEVEL_SUBDIVISION
+    uint8_t subdivision = bed_level_subdivision;
+  #else
+    uint8_t subdivision = 1;
+  #endif
+  int i=EEPROM_MESH_OFFSET;
+  EEPROM_WRITE_VAR(i,ver); // invalidate data first
+  int start=i;
+  EEPROM_WRITE_VAR(i,layout);
+  #ifdef BED_LEVEL_POLAR
+    EEPROM_WRITE_VAR(i,bed_level_center);
+    for (int ring = 0; ring < BED_LEVEL_POLAR_RINGS; ring++)
+      EEPROM_WRITE_VAR(i,bed_level_polar[ring]);
+  #else
+    for (int x = 0; x < AUTO_BED_LEVELING_GRID_POINTS; x++)
+      EEPROM_WRITE_VAR(i,bed_level[x]);
+  #endif
+  EEPROM_WRITE_VAR(i,subdivision);
+  uint16_t crc = eeprom_crc(start, i);
+  EEPROM_WRITE_VAR(i,crc);
+  char ver2[4]=EEPROM_MESH_VERSION;
+  i=EEPROM_MESH_OFFSET;
+  EEPROM_WRITE_VAR(i,ver2); // validate data
+  SERIAL_ECHO_START;
+  SERIAL_ECHOLNPGM("Mesh Stored");
+}
+
+// Load the mesh if EEPROM holds a valid one for this layout; otherwise leave it alone.
+bool Config_RetrieveMesh()
+{
+  int i=EEPROM_MESH_OFFSET;
+  char stored_ver[4];
+  char ver[4]=EEPROM_MESH_VERSION;
+  uint8_t stored_layout[3];
+  uint8_t layout[3] = EEPROM_MESH_LAYOUT;
+  EEPROM_READ_VAR(i,stored_ver);
+  int start=i;
+  EEPROM_READ_VAR(i,stored_layout);
+  if (strncmp(ver,stored_ver,3) != 0 || memcmp(layout,stored_layout,sizeof(layout)) != 0)
+  {
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("No stored mesh");
+    return false;
+  }
+  #ifdef BED_LEVEL_POLAR
+    int end = i + sizeof(bed_level_center) + sizeof(bed_level_polar) + 1;
+  #else
+    int end = i + sizeof(bed_level) + 1;
+  #endif
+  int crc_pos = end;
+  uint16_t stored_crc;
+  EEPROM_READ_VAR(crc_pos,stored_crc);
+  if (eeprom_crc(start, end) != stored_crc)
+  {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("Stored mesh CRC mismatch");
+    return false;
+  }
+  #ifdef BED_LEVEL_POLAR
+    EEPROM_READ_VAR(i,bed_level_center);
+    for (int ring = 0; ring < BED_LEVEL_POLAR_RINGS; ring++)
+      EEPROM_READ_VAR(i,bed_level_polar[ring]);
+  #else
+    for (int x = 0; x < AUTO_BED_LEVELING_GRID_POINTS; x++)
+      EEPROM_READ_VAR(i,bed_level[x]);
+  #endif
+  uint8_t subdivision;
+  EEPROM_READ_VAR(i,subdivision);
+  #ifdef BED_LEVEL_SUBDIVISION
+    if (subdivision >= 1 && (AUTO_BED_LEVELING_GRID_POINTS - 1) * subdivision + 1 <= BED_LEVEL_MESH_MAX_POINTS)
+      bed_level_subdivision = subdivision;
+  #endif
+  bed_level_updated();
+  SERIAL_ECHO_START;
+  SERIAL_ECHOLNPGM("Stored mesh retrieved");
+  return true;
+}
+#endif //BED_LEVEL_EEPROM
+
 
 #ifndef DISABLE_M503
 void Config_PrintSettings()
@@ -226,6 +365,15 @@ SERIAL_ECHOLNPGM("Scaling factors:");
 	SERIAL_ECHOPAIR(" S" ,delta_segments_per_second );
 	SERIAL_ECHOLN("");
 #endif
+#ifdef PROBE_TWO_SPEED
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Probe speeds (mm/s) and re-tap back-off (mm):");
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR("  M377 F" ,probe_fast_feedrate);
+    SERIAL_ECHOPAIR(" S" ,probe_slow_feedrate);
+    SERIAL_ECHOPAIR(" B" ,probe_retap_backoff);
+    SERIAL_ECHOLN("");
+#endif
 #ifdef PIDTEMP
     SERIAL_ECHO_START;
     SERIAL_ECHOLNPGM("PID settings:");
@@ -278,6 +426,11 @@ void Config_RetrieveSettings()
         // Update delta constants for updated delta_radius & tower_adj values
         set_delta_constants();
         #endif
+        #ifdef PROBE_TWO_SPEED
+        EEPROM_READ_VAR(i,probe_fast_feedrate);
+        EEPROM_READ_VAR(i,probe_slow_feedrate);
+        EEPROM_READ_VAR(i,probe_retap_backoff);
+        #endif
         #ifndef ULTIPANEL
         int plaPreheatHotendTemp, plaPreheatHPBTemp, plaPreheatFanSpeed;
         int absPreheatHotendTemp, absPreheatHPBTemp, absPreheatFanSpeed;
@@ -376,6 +529,11 @@ void Config_ResetDefault()
 #ifdef ENABLE_AUTO_BED_LEVELING
     zprobe_zoffset = -Z_PROBE_OFFSET_FROM_EXTRUDER;
 #endif
+#ifdef PROBE_TWO_SPEED
+    probe_fast_feedrate = PROBE_FAST_FEEDRATE;
+    probe_slow_feedrate = AUTOCAL_PROBERATE;
+    probe_retap_backoff = PROBE_RETAP_BACKOFF;
+#endif
 #ifdef DOGLCD
     lcd_contrast = DEFAULT_LCD_CONTRAST;
 #endif
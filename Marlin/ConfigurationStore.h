@@ -19,4 +19,9 @@ FORCE_INLINE void Config_StoreSettings() {}
 FORCE_INLINE void Config_RetrieveSettings() { Config_ResetDefault(); Config_PrintSettings(); }
 #endif
 
+#ifdef BED_LEVEL_EEPROM
+void Config_StoreMesh();
+bool Config_RetrieveMesh();
+#endif
+
 #endif//CONFIG_STORE_H
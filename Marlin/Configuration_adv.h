@@ -138,6 +138,11 @@
 
 //#define Z_LATE_ENABLE // Enable Z the last moment. Needed if your Z driver overheats.
 
+// Time every stepper ISR run with TCNT1, per code path (idle, block load, accel, cruise, decel) and
+// per step_loops setting, and count runs that made the next step late. Costs about 250 bytes of RAM
+// and a few us per run. M380 reports the figures, M380 C clears them.
+//#define STEPPER_ISR_TIMING
+
 // A single Z stepper driver is usually used to drive 2 stepper motors.
 // Uncomment this define to utilize a separate stepper driver for each Z axis motor.
 // Only a few motherboards support this, like RAMPS, which have dual extruder support (the 2nd, often unused, extruder driver is used
@@ -395,11 +400,26 @@ const unsigned int dropsegments=5; //everything with less than this number of st
 
 // The number of linear motions that can be in the plan at any give time.
 // THE BLOCK_BUFFER_SIZE NEEDS TO BE A POWER OF 2, i.g. 8,16,32 because shifts and ors are used to do the ring-buffering.
+#ifndef BLOCK_BUFFER_SIZE // may be given on the compiler command line, e.g. by the host benchmark
 #if defined SDSUPPORT
   #define BLOCK_BUFFER_SIZE 16   // SD,LCD,Buttons take more memory, block buffer needs to be smaller
 #else
   #define BLOCK_BUFFER_SIZE 64 // maximize block buffer
 #endif
+#endif
+
+// Time plan_buffer_line(), planner_recalculate() and calculate_trapezoid_for_block() (and on a delta
+// the kinematics of each move segment) and count the blocks the recalculation passes visit.
+// M379 reports the figures, M379 C clears them.
+// Marlin/hostsim "make bench" runs the same counters over sample G-code on the host.
+//#define PLANNER_TIMING
+
+// Count planner underruns (a block finished with nothing queued behind it outside st_synchronize(),
+// so the machine stopped), the fewest blocks left queued, the time plan_buffer_line() waited for a
+// free block and the command queue depth. M381 reports and starts a new window (send it from the
+// slicer's layer change G-code for per-layer figures), M381 C clears, M381 S<seconds> auto-reports.
+//#define BUFFER_STATS
+#define BUFFER_STATS_INTERVAL 0 // s between automatic M381 reports, 0 = off
 
 
 //The ASCII buffer for receiving from the serial:
@@ -443,6 +463,90 @@ const unsigned int dropsegments=5; //everything with less than this number of st
   #endif
 #endif
 
+#if defined(DELTA_FIXED_POINT_KINEMATICS) && defined(DELTA_INCREMENTAL_KINEMATICS)
+  #error "Enable only one of DELTA_FIXED_POINT_KINEMATICS and DELTA_INCREMENTAL_KINEMATICS"
+#endif
+
+#if defined(DELTA_FIXED_POINT_KINEMATICS) && defined(ENABLE_AUTO_BED_LEVELING) && !defined(NONLINEAR_BED_LEVELING)
+  #error "DELTA_FIXED_POINT_KINEMATICS does not apply the bed level plane, use NONLINEAR_BED_LEVELING"
+#endif
+
+#ifdef BED_LEVEL_POLAR
+  #if !defined(DELTA) || !defined(NONLINEAR_BED_LEVELING)
+    #error "BED_LEVEL_POLAR needs DELTA and NONLINEAR_BED_LEVELING"
+  #endif
+  #ifdef BED_LEVEL_SUBDIVISION
+    #error "Enable only one of BED_LEVEL_POLAR and BED_LEVEL_SUBDIVISION"
+  #endif
+#endif
+
+#ifdef PROBE_ADAPTIVE
+  #ifdef PROBE_AVG
+    #error "PROBE_ADAPTIVE replaces PROBE_AVG, disable one of them"
+  #endif
+  #if defined(SERVO_ENDSTOPS) || !defined(ENABLE_AUTO_BED_LEVELING)
+    #error "PROBE_ADAPTIVE needs ENABLE_AUTO_BED_LEVELING and a probe that stays engaged (no SERVO_ENDSTOPS)"
+  #endif
+  #if PROBE_ADAPTIVE_MIN < 2 || PROBE_ADAPTIVE_MAX < PROBE_ADAPTIVE_MIN
+    #error "PROBE_ADAPTIVE needs 2 <= PROBE_ADAPTIVE_MIN <= PROBE_ADAPTIVE_MAX"
+  #endif
+#endif
+
+#if defined(PROBE_TWO_SPEED) && (!defined(DELTA) || defined(SERVO_ENDSTOPS))
+  #error "PROBE_TWO_SPEED needs DELTA and a probe that stays engaged (no SERVO_ENDSTOPS)"
+#endif
+
+#ifdef PROBE_LOG
+  #ifndef ENABLE_AUTO_BED_LEVELING
+    #error "PROBE_LOG logs the probe_pt() readings, it needs ENABLE_AUTO_BED_LEVELING"
+  #endif
+  #if PROBE_LOG_SIZE < 1 || PROBE_LOG_SIZE > 255
+    #error "PROBE_LOG_SIZE must be between 1 and 255"
+  #endif
+#endif
+
+#if defined(AUTOCAL_PIPELINE) && !defined(DELTA)
+  #error "AUTOCAL_PIPELINE pipelines the delta G30 calibration, it needs DELTA"
+#endif
+
+#if defined(PROBE_FLYBY) && !defined(PROBE_TWO_SPEED)
+  #error "PROBE_FLYBY ends its travel in the PROBE_TWO_SPEED approach, enable PROBE_TWO_SPEED"
+#endif
+
+#if defined(PROBE_TRIGGER_INTERPOLATION) && !defined(DELTA)
+  #error "PROBE_TRIGGER_INTERPOLATION corrects the delta probe (run_z_probe), it needs DELTA"
+#endif
+
+#ifdef DELTA_LEAST_SQUARES_CALIBRATION
+  #if !defined(DELTA) || !defined(AUTO_BED_LEVELING_GRID)
+    #error "DELTA_LEAST_SQUARES_CALIBRATION needs DELTA and AUTO_BED_LEVELING_GRID (for qr_solve)"
+  #endif
+  #if DELTA_CALIBRATION_POINTS < 7 || DELTA_CALIBRATION_POINTS > 13
+    #error "DELTA_CALIBRATION_POINTS must be between 7 and 13"
+  #endif
+#endif
+
+#ifdef BED_LEVEL_EEPROM
+  #if !defined(EEPROM_SETTINGS) || !defined(NONLINEAR_BED_LEVELING)
+    #error "BED_LEVEL_EEPROM needs EEPROM_SETTINGS and NONLINEAR_BED_LEVELING"
+  #endif
+#endif
+
+#ifdef BED_LEVEL_ADAPTIVE
+  #if !defined(NONLINEAR_BED_LEVELING) || defined(BED_LEVEL_POLAR)
+    #error "BED_LEVEL_ADAPTIVE refines the NONLINEAR_BED_LEVELING grid, not BED_LEVEL_POLAR"
+  #endif
+  #if AUTO_BED_LEVELING_GRID_POINTS % 2 == 0 || AUTO_BED_LEVELING_GRID_POINTS < 5
+    #error "BED_LEVEL_ADAPTIVE needs an odd AUTO_BED_LEVELING_GRID_POINTS of 5 or more"
+  #endif
+#endif
+
+#ifdef BED_LEVEL_SUBDIVISION
+  #if (AUTO_BED_LEVELING_GRID_POINTS - 1) * BED_LEVEL_SUBDIVISION_DEFAULT + 1 > BED_LEVEL_MESH_MAX_POINTS
+    #error "BED_LEVEL_SUBDIVISION_DEFAULT does not fit in BED_LEVEL_MESH_MAX_POINTS"
+  #endif
+#endif
+
 //===========================================================================
 //=============================  Define Defines  ============================
 //===========================================================================
@@ -186,6 +186,40 @@ void set_default_z_probe_offset();
 void set_delta_constants();
 void save_carriage_positions(int position_num);
 void calculate_delta(float cartesian[3]);
+void calculate_cartesian(const float delta_pos[3], float cartesian[3]);
+void calculate_cartesian(const float delta_pos[3], float cartesian[3],
+                         const float tower_x[3], const float tower_y[3], const float rod_2[3]);
+void get_cartesian_from_steppers(float cartesian[3]);
+#ifdef DELTA_INCREMENTAL_KINEMATICS
+void calculate_delta_incremental_start(const float difference[3], int segments);
+void calculate_delta_incremental(float cartesian[3], int segment, int segments);
+#endif
+#ifdef DELTA_ADAPTIVE_SEGMENTS
+float delta_segments_for_error(const float start[3], const float difference[3]);
+#endif
+#ifdef DELTA_FIXED_POINT_KINEMATICS
+void calculate_delta_steps_init();
+void calculate_delta_steps(float cartesian[3], long delta_steps[3]);
+#endif
+#ifdef DELTA_LEAST_SQUARES_CALIBRATION
+float delta_lsq_fit(const float carriage[][3], const float probe_z[], int m, int factors, float p[7]);
+#endif
+#ifdef NONLINEAR_BED_LEVELING
+#ifdef BED_LEVEL_POLAR
+extern float bed_level_center;
+extern float bed_level_polar[BED_LEVEL_POLAR_RINGS][BED_LEVEL_POLAR_SPOKES];
+#else
+extern float bed_level[AUTO_BED_LEVELING_GRID_POINTS][AUTO_BED_LEVELING_GRID_POINTS];
+#endif
+#ifdef BED_LEVEL_SUBDIVISION
+extern uint8_t bed_level_subdivision;
+#endif
+void bed_level_updated();
+#ifdef BED_LEVEL_ADAPTIVE
+uint8_t refine_bed_level(const uint8_t order[], uint8_t points, bool wanted[], uint8_t *blocks);
+#endif
+#endif
+float bed_level_offset(float cartesian[3]);
 void adjust_delta(float cartesian[3]);
 void adj_endstops();
 extern float delta[3];
@@ -246,6 +280,11 @@ extern float min_pos[3];
 extern float max_pos[3];
 extern bool axis_known_position[3];
 extern float zprobe_zoffset;
+#ifdef PROBE_TWO_SPEED
+extern float probe_fast_feedrate;
+extern float probe_slow_feedrate;
+extern float probe_retap_backoff;
+#endif
 extern int fanSpeed;
 #ifdef BARICUDA
 extern int ValvePressure;
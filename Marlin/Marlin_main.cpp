@@ -34,6 +34,12 @@
   #ifdef AUTO_BED_LEVELING_GRID
     #include "qr_solve.h"
   #endif
+  #if defined(PROBE_ADAPTIVE) || defined(Z_PROBE_REPEATABILITY_TEST)
+    #include "probe_sampler.h"
+  #endif
+  #ifdef PROBE_LOG
+    #include "probe_log.h"
+  #endif
 #endif // ENABLE_AUTO_BED_LEVELING
 
 #include "ultralcd.h"
@@ -48,6 +54,10 @@
 #include "pins_arduino.h"
 #include "math.h"
 
+#ifdef BUFFER_STATS
+#include "buffer_stats.h"
+#endif
+
 #ifdef BLINKM
 #include "BlinkM.h"
 #include "Wire.h"
@@ -78,6 +88,7 @@
 // G28 - Home all Axis
 // G29 - Detailed Z-Probe, probes the bed at 3 or more points.  Will fail if you haven't homed yet.
 // G30 - Bed Probe and Delta geometry Autocalibration
+//       L<factors> P<passes> - least squares calibration (DELTA_LEAST_SQUARES_CALIBRATION)
 // G31 - Dock sled (Z_PROBE_SLED only)
 // G32 - Undock sled (Z_PROBE_SLED only)
 // G90 - Use Absolute Coordinates
@@ -122,7 +133,7 @@
 //        Rxxx Wait for extruder current temp to reach target temp. Waits when heating and cooling
 //        IF AUTOTEMP is enabled, S<mintemp> B<maxtemp> F<factor>. Exit autotemp by any M109 without F
 // M112 - Emergency stop
-// M114 - Output current position to serial port
+// M114 - Output current position to serial port. Delta: R also reports the real position from the stepper counts
 // M115 - Capabilities string
 // M117 - display message
 // M119 - Output Endstop status to serial port
@@ -176,6 +187,14 @@
 // M908 - Control digital trimpot directly.
 // M350 - Set microstepping mode.
 // M351 - Toggle MS1 MS2 pins directly.
+// M374 - Save the bed_level mesh to EEPROM (BED_LEVEL_EEPROM)
+// M375 - Load the bed_level mesh from EEPROM (BED_LEVEL_EEPROM)
+// M376 - Report the active bed_level mesh
+// M377 - Set two-speed probing F<fast mm/s> S<slow mm/s> B<re-tap back-off mm> (PROBE_TWO_SPEED)
+// M378 - Dump the probe log as CSV, C clears it (PROBE_LOG)
+// M379 - Report planner timing, C clears it (PLANNER_TIMING)
+// M380 - Report stepper ISR timing, C clears it (STEPPER_ISR_TIMING)
+// M381 - Report planner underruns and buffer occupancy and start a new window, C clears, S<seconds> auto-report interval (BUFFER_STATS)
 
 // ************ SCARA Specific - This can change to suit future G-code regulations
 // M360 - SCARA calibration: Move to cal-position ThetaA (0 deg calibration)
@@ -264,6 +283,29 @@ float min_pos[3] = { X_MIN_POS, Y_MIN_POS, Z_MIN_POS };
 float max_pos[3] = { X_MAX_POS, Y_MAX_POS, Z_MAX_POS };
 bool axis_known_position[3] = {false, false, false};
 float zprobe_zoffset;
+#ifdef PROBE_TWO_SPEED
+float probe_fast_feedrate = PROBE_FAST_FEEDRATE;
+float probe_slow_feedrate = AUTOCAL_PROBERATE;
+float probe_retap_backoff = PROBE_RETAP_BACKOFF;
+  #define PROBE_SAMPLE_RATE probe_slow_feedrate
+  #define PROBE_SAMPLE_LIFT probe_retap_backoff
+#else
+  #define PROBE_SAMPLE_RATE AUTOCAL_PROBERATE
+  #define PROBE_SAMPLE_LIFT Z_RAISE_BETWEEN_PROBINGS
+#endif
+#ifdef PROBE_FLYBY
+// Last probed nozzle position and the steepest slope seen between probes
+static bool probe_flyby_valid = false;
+static float probe_flyby_x, probe_flyby_y, probe_flyby_z;
+static float probe_flyby_slope;
+static bool probe_flyby_early; // the last run_z_probe() touched down before its approach
+#endif
+#ifdef AUTOCAL_PIPELINE
+// The G30 point probed after the current one, so probe_pt() can queue the travel as soon as it
+// has its reading
+static bool probe_next_valid = false;
+static float probe_next_x, probe_next_y;
+#endif
 
 // Extruder offset
 #if EXTRUDERS > 1
@@ -336,7 +378,26 @@ int EtoPPressure=0;
 #endif
 
 #ifdef NONLINEAR_BED_LEVELING
+#ifdef BED_LEVEL_POLAR
+// Polar mesh: the centre, and bed_level_polar[ring - 1][spoke] for rings 1..BED_LEVEL_POLAR_RINGS.
+float bed_level_center;
+float bed_level_polar[BED_LEVEL_POLAR_RINGS][BED_LEVEL_POLAR_SPOKES];
+// Directions of the two spokes of sector bed_level_cell_y: cos, sin, cos, sin.
+static float bed_level_spoke[4];
+#else
 float bed_level[AUTO_BED_LEVELING_GRID_POINTS][AUTO_BED_LEVELING_GRID_POINTS];
+#endif //BED_LEVEL_POLAR
+// Bilinear coefficients of the bed_level cell last used by bed_level_offset().
+// bed_level_cell_x is -1 when bed_level has changed since.
+static int8_t bed_level_cell_x = -1, bed_level_cell_y = -1;
+static float bed_level_cell[4];
+#ifdef BED_LEVEL_SUBDIVISION
+// Mesh interpolated from bed_level, bed_level_mesh_points per side.
+float bed_level_mesh[BED_LEVEL_MESH_MAX_POINTS * BED_LEVEL_MESH_MAX_POINTS];
+#define BED_LEVEL_MESH(x, y) bed_level_mesh[(x) * bed_level_mesh_points + (y)]
+uint8_t bed_level_subdivision = BED_LEVEL_SUBDIVISION_DEFAULT;
+uint8_t bed_level_mesh_points = (AUTO_BED_LEVELING_GRID_POINTS - 1) * BED_LEVEL_SUBDIVISION_DEFAULT + 1;
+#endif //BED_LEVEL_SUBDIVISION
 #endif //NONLINEAR_BED_LEVELING
 #ifdef SCARA                              // Build size scaling
 float axis_scaling[3]={1,1,1};  // Build size scaling, default to 1
@@ -604,6 +665,9 @@ void setup()
 
   // loads data from EEPROM if available else uses defaults (and resets step acceleration rate)
   Config_RetrieveSettings();
+  #ifdef BED_LEVEL_EEPROM
+    Config_RetrieveMesh();
+  #endif
 
   tp_init();    // Initialize temperature loop
   plan_init();  // Initialize planner;
@@ -639,6 +703,9 @@ void loop()
   #endif
   if(buflen)
   {
+    #ifdef BUFFER_STATS
+      buffer_stats_command(buflen);
+    #endif
     #ifdef SDSUPPORT
       if(card.saving)
       {
@@ -999,6 +1066,7 @@ static void axis_is_at_home(int axis) {
 
 #ifdef ENABLE_AUTO_BED_LEVELING
 #ifdef AUTO_BED_LEVELING_GRID
+#ifndef NONLINEAR_BED_LEVELING
 static void set_bed_level_equation_lsq(double *plane_equation_coefficients)
 {
     vector_3 planeNormal = vector_3(-plane_equation_coefficients[0], -plane_equation_coefficients[1], 1);
@@ -1021,6 +1089,7 @@ static void set_bed_level_equation_lsq(double *plane_equation_coefficients)
 
     plan_set_position(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[E_AXIS]);
 }
+#endif // NONLINEAR_BED_LEVELING
 
 #else // not AUTO_BED_LEVELING_GRID
 
@@ -1053,33 +1122,50 @@ static void set_bed_level_equation_3pts(float z_at_pt_1, float z_at_pt_2, float
 
 #endif // AUTO_BED_LEVELING_GRID
 
-static void run_z_probe() {
+// rate is the descent speed in mm/s (delta only)
+static void run_z_probe(float rate = PROBE_SAMPLE_RATE) {
     plan_bed_level_matrix.set_to_identity();
 
 #ifdef DELTA
     enable_endstops(true);
-    float start_z = current_position[Z_AXIS];
-    long start_steps = st_get_position(Z_AXIS);
 
     //feedrate = homing_feedrate[Z_AXIS]/10;
-    feedrate = AUTOCAL_PROBERATE *60;
+    feedrate = rate * 60;
     destination[Z_AXIS] = -10;
+    #ifdef PROBE_TRIGGER_INTERPOLATION
+      st_probe_trigger_arm();
+    #endif
     prepare_move_raw();
     st_synchronize();
     endstops_hit_on_purpose();
+    #ifdef PROBE_FLYBY
+      // The stepper dropped the approach (and any travel left) if the probe touched before it;
+      // the position is read back from the carriages below either way
+      probe_flyby_early = st_probe_stop_disarm();
+    #endif
 
     enable_endstops(false);
-    long stop_steps = st_get_position(Z_AXIS);
-
-    float mm = start_z - float(start_steps - stop_steps) / axis_steps_per_unit[Z_AXIS];
-    current_position[Z_AXIS] = mm;
-    calculate_delta(current_position);
-    plan_set_position(delta[X_AXIS], delta[Y_AXIS], delta[Z_AXIS], current_position[E_AXIS]);
 
     //**PJR - Save tower carriage positions for G30 diagnostic reports
+    float stop_position[3];
     for(int8_t i=0; i < 3; i++) {
-      saved_position[i] = st_get_position_mm(i);
+      stop_position[i] = saved_position[i] = float(st_get_position(i)) / axis_steps_per_unit[i];
     }
+
+    #ifdef PROBE_TRIGGER_INTERPOLATION
+      // The endstop check needs two reads in a row, so the carriages overshoot the trigger by a
+      // step or two. Report where the probe fired; the planner still gets where they stopped.
+      // A trigger further back than that overshoot was a bounce, and the stop position stands.
+      float trigger_steps[3];
+      if (st_probe_trigger_position(trigger_steps)) {
+        for(int8_t i=0; i < 3; i++) saved_position[i] = trigger_steps[i] / axis_steps_per_unit[i];
+      }
+    #endif
+
+    // The carriages stopped wherever the probe triggered, so take the effector
+    // position from all three towers rather than from the Z tower alone.
+    calculate_cartesian(saved_position, current_position);
+    plan_set_position(stop_position[X_AXIS], stop_position[Y_AXIS], stop_position[Z_AXIS], current_position[E_AXIS]);
 #else
     feedrate = homing_feedrate[Z_AXIS];
 
@@ -1109,6 +1195,25 @@ static void run_z_probe() {
 #endif
 }
 
+#ifdef PROBE_SETTLE_MONITOR
+// Wait for the Z probe to read released without a bounce for PROBE_SETTLE_WINDOW ms.
+// Returns the time taken, PROBE_SETTLE_TIMEOUT if it never settled.
+static unsigned long probe_wait_for_release() {
+  unsigned long start = millis(), released_at = start;
+  for (;;) {
+    unsigned long now = millis();
+    if (READ(Z_MIN_PIN) != Z_MIN_ENDSTOP_INVERTING)
+      released_at = now; // still pressed, or bounced
+    else if (now - released_at >= PROBE_SETTLE_WINDOW)
+      return released_at - start;
+    if (now - start >= PROBE_SETTLE_TIMEOUT)
+      return PROBE_SETTLE_TIMEOUT;
+    manage_heater();
+    manage_inactivity();
+  }
+}
+#endif //PROBE_SETTLE_MONITOR
+
 static void do_blocking_move_to(float x, float y, float z) {
     float oldFeedRate = feedrate;
 
@@ -1134,6 +1239,18 @@ static void do_blocking_move_relative(float offset_x, float offset_y, float offs
     do_blocking_move_to(current_position[X_AXIS] + offset_x, current_position[Y_AXIS] + offset_y, current_position[Z_AXIS] + offset_z);
 }
 
+#ifdef PROBE_SETTLE_MONITOR
+static unsigned long probe_settle_worst; // longest probe_lift() wait of the current probe_pt()
+#endif
+
+// Lift off the bed between taps; with PROBE_SETTLE_MONITOR, also wait for the probe to release
+static void probe_lift(float lift) {
+    do_blocking_move_to(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS] + lift);
+#ifdef PROBE_SETTLE_MONITOR
+    probe_settle_worst = max(probe_settle_worst, probe_wait_for_release());
+#endif
+}
+
 // **PJR - Do a blocking cartesian (delta segmented if appropriate) move to specified location at XY_TRAVEL_SPEED.
 // NB this will respect bed level corrections if enabled and not cleared
 static void do_blocking_move_cartesian(float x, float y, float z) {
@@ -1269,10 +1386,88 @@ static void retract_z_probe() {
     st_synchronize();
     #endif //SERVO_ENDSTOPS
 }
+#ifdef PROBE_FLYBY
+// Start a new probing session: forget the surface and the slope measured so far
+static void probe_flyby_reset() {
+  probe_flyby_valid = false;
+  probe_flyby_slope = 0;
+}
+
+// Queue a lift, travel and (through run_z_probe) the approach as one stream of moves: the
+// nozzle stays a clearance above the last probed height, growing with the slope seen so far.
+static void probe_flyby_move(float x, float y) {
+  float hop = sqrt(sq(x - probe_flyby_x) + sq(y - probe_flyby_y));
+  float z = probe_flyby_z + min(PROBE_FLYBY_CLEARANCE + probe_flyby_slope * hop, Z_RAISE_BETWEEN_PROBINGS);
+  float oldFeedRate = feedrate;
+  feedrate = XY_TRAVEL_SPEED;
+  // Stop where the travel meets the bed rather than drag the pressed probe over it
+  st_probe_stop_arm();
+  if (z > current_position[Z_AXIS]) {
+    destination[X_AXIS] = current_position[X_AXIS];
+    destination[Y_AXIS] = current_position[Y_AXIS];
+    destination[Z_AXIS] = z;
+    prepare_move_raw();
+  }
+  // segmented, so the effector stays level on a delta
+  destination[X_AXIS] = x;
+  destination[Y_AXIS] = y;
+  destination[Z_AXIS] = z;
+  prepare_move();
+  feedrate = oldFeedRate;
+}
+#endif //PROBE_FLYBY
+
+#ifdef DELTA
+// Lift off the bed if needed and queue the travel to above (x, y) for probe_bed(), without waiting
+static void probe_bed_travel(float x, float y) {
+  //**PJR - Lift the probe if below minimum level (eg sat on bed after a previous probing)
+  if (current_position[Z_AXIS] < (AUTOCAL_PROBELIFT - z_probe_offset[Z_AXIS]))
+  {
+    feedrate = AUTOCAL_TRAVELRATE * 60;
+    destination[X_AXIS] = current_position[X_AXIS];
+    destination[Y_AXIS] = current_position[Y_AXIS];
+    destination[Z_AXIS] = current_position[Z_AXIS] + AUTOCAL_PROBELIFT;
+    prepare_move();
+  }
+
+  //**PJR - Move to probing point using a delta safe move.
+  feedrate = AUTOCAL_TRAVELRATE * 60;
+  destination[X_AXIS] = x - z_probe_offset[X_AXIS];
+  destination[Y_AXIS] = y - z_probe_offset[Y_AXIS];
+  destination[Z_AXIS] = current_position[Z_AXIS];
+  prepare_move();
+}
+#endif //DELTA
+
+#ifdef AUTOCAL_PIPELINE
+// Queue the travel to the G30 point (x, y) now, so whatever the caller does next (bookkeeping,
+// geometry updates, serial reports) runs while the carriages move. probe_bed() there then only
+// waits for it to finish.
+static void probe_bed_queue(float x, float y) {
+  #ifdef PROBE_FLYBY
+  if (probe_flyby_valid) {
+    probe_flyby_move(x - z_probe_offset[X_AXIS], y - z_probe_offset[Y_AXIS]);
+    return;
+  }
+  #endif
+  probe_bed_travel(x, y);
+}
+
+// Have the next probe_pt() queue the travel to (x, y) right after its last trigger
+static void probe_bed_then(float x, float y) {
+  probe_next_x = x;
+  probe_next_y = y;
+  probe_next_valid = true;
+}
+#endif //AUTOCAL_PIPELINE
+
 /// Probe bed height at position (x,y), returns the measured z value **PJR - Z probe offset must be handled by caller.
 static float probe_pt(float x, float y, float z_before) {
 
-#ifdef PROBE_AVG
+#if defined(PROBE_ADAPTIVE)
+  probe_sampler sampler;
+  bool probe_done;
+#elif defined(PROBE_AVG)
   int num_probes=PROBE_AVG;
   float total=0.0;
   float probe_bed_array[PROBE_AVG];
@@ -1282,18 +1477,71 @@ static float probe_pt(float x, float y, float z_before) {
 #endif
   int probe_count;
   float probe_z; 
+#ifdef PROBE_LOG
+  unsigned long probe_started = millis();
+#endif
+#ifdef PROBE_SETTLE_MONITOR
+  probe_settle_worst = 0;
+#endif
 
   // move to right place
+#ifdef PROBE_FLYBY
+  if (probe_flyby_valid)
+    probe_flyby_move(x - z_probe_offset[X_AXIS], y - z_probe_offset[Y_AXIS]);
+  else
+#endif
+  {
   do_blocking_move_to(current_position[X_AXIS], current_position[Y_AXIS], z_before);
   do_blocking_move_to(x - z_probe_offset[X_AXIS], y - z_probe_offset[Y_AXIS], current_position[Z_AXIS]);
+  }
+
+#ifdef PROBE_TWO_SPEED
+  // Find the surface quickly; the samples are then slow re-taps from just above it
+  run_z_probe(probe_fast_feedrate);
+  #ifdef PROBE_FLYBY
+  // Touching down on the travel, short of the point, means the bed rose faster than the clearance allowed
+  if (probe_flyby_early) {
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Fly-by touched early, lifting fully");
+    do_blocking_move_to(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS] + Z_RAISE_BETWEEN_PROBINGS);
+    // segmented: across the bed, a raw delta move sags by more than the lift
+    float oldFeedRate = feedrate;
+    feedrate = XY_TRAVEL_SPEED;
+    destination[X_AXIS] = x - z_probe_offset[X_AXIS];
+    destination[Y_AXIS] = y - z_probe_offset[Y_AXIS];
+    destination[Z_AXIS] = current_position[Z_AXIS];
+    prepare_move();
+    st_synchronize();
+    feedrate = oldFeedRate;
+    run_z_probe(probe_fast_feedrate);
+  }
+  #endif
+  probe_lift(probe_retap_backoff);
+#endif
+
+#if defined(PROBE_ADAPTIVE)
+  //Tap until the mean of the taps that agree is known well enough
+  sampler.reset(1.0 / axis_steps_per_unit[Z_AXIS]);
+  probe_count = 0;
+  do {
+    if (probe_count > 0)
+    {
+      probe_lift(PROBE_SAMPLE_LIFT);
+    }
+
+    run_z_probe();
+    probe_done = sampler.add(current_position[Z_AXIS]);
+    probe_count ++;
+    } while (!probe_done);
+  probe_z = sampler.mean;
 
-#ifdef PROBE_AVG
+#elif defined(PROBE_AVG)
   for(probe_count=0;probe_count<num_probes;probe_count++)
     {
     if (probe_count > 0)
       {
       //**PJR - Lift the probe before next sample
-      do_blocking_move_to(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS] + Z_RAISE_BETWEEN_PROBINGS);
+      probe_lift(PROBE_SAMPLE_LIFT);
       }
 
 #if defined(SERVO_ENDSTOPS) && !defined(Z_PROBE_SLED)
@@ -1321,7 +1569,7 @@ static float probe_pt(float x, float y, float z_before) {
     if (probe_count > 0)
     {
       //**PJR - Lift the probe before next sample
-      do_blocking_move_to(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS] + Z_RAISE_BETWEEN_PROBINGS);
+      probe_lift(PROBE_SAMPLE_LIFT);
     }
 
 #if defined(SERVO_ENDSTOPS) && !defined(Z_PROBE_SLED)
@@ -1362,6 +1610,43 @@ static float probe_pt(float x, float y, float z_before) {
     } while ((probe_done == false) and (probe_count < 20));
    //**PJR - Remove confusing diagnostic messages
  #endif 
+
+#ifdef PROBE_FLYBY
+  {
+    float probe_x = x - z_probe_offset[X_AXIS], probe_y = y - z_probe_offset[Y_AXIS];
+    float hop = sqrt(sq(probe_x - probe_flyby_x) + sq(probe_y - probe_flyby_y));
+    if (probe_flyby_valid && hop > 1)
+      probe_flyby_slope = max(probe_flyby_slope, fabs(probe_z - probe_flyby_z) / hop);
+    probe_flyby_x = probe_x;
+    probe_flyby_y = probe_y;
+    probe_flyby_z = probe_z;
+    probe_flyby_valid = true;
+  }
+#endif
+
+#ifdef AUTOCAL_PIPELINE
+  // The reading is in, so head for the next point while this one is reported
+  if (probe_next_valid) {
+    probe_next_valid = false;
+    probe_bed_queue(probe_next_x, probe_next_y);
+  }
+#endif
+
+#if defined(PROBE_LOG)
+  // Logged instead of printed, so probing does not wait on the serial port
+  #ifdef PROBE_SETTLE_MONITOR
+  uint16_t probe_settle = min(probe_settle_worst, 65535UL);
+  #else
+  uint16_t probe_settle = 0;
+  #endif
+  #if defined(PROBE_ADAPTIVE)
+  probe_log_add(x, y, probe_z, sampler.sigma, sampler.count, probe_started, probe_settle);
+  #elif defined(PROBE_AVG)
+  probe_log_add(x, y, probe_z, probe_log_sigma(probe_bed_array, num_probes), num_probes, probe_started, probe_settle);
+  #else
+  probe_log_add(x, y, probe_z, probe_log_sigma(probe_bed_array, probe_count), probe_count, probe_started, probe_settle);
+  #endif
+#else
   //SERIAL_PROTOCOLPGM(MSG_BED);
   SERIAL_PROTOCOLPGM(" x: ");
   SERIAL_PROTOCOL(x);
@@ -1369,7 +1654,15 @@ static float probe_pt(float x, float y, float z_before) {
   SERIAL_PROTOCOL(y);
   SERIAL_PROTOCOLPGM(" z: ");
   SERIAL_PROTOCOL(probe_z); //**PJR - This is the measured Z at probe deployed height - confusing to user
-#ifndef PROBE_AVG
+#if defined(PROBE_ADAPTIVE)
+  SERIAL_PROTOCOLPGM(" taps: ");
+  SERIAL_PROTOCOL(int(sampler.accepted));
+  SERIAL_PROTOCOLPGM("/");
+  SERIAL_PROTOCOL(int(sampler.count));
+  SERIAL_PROTOCOLPGM(" sigma: ");
+  SERIAL_PROTOCOL_F(sampler.sigma, 4);
+  SERIAL_PROTOCOLPGM("\n");
+#elif !defined(PROBE_AVG)
   SERIAL_PROTOCOLPGM(" bed_array[] = [");
   for(int xx=0;xx < probe_count; xx++) {
     SERIAL_PROTOCOL(probe_bed_array[xx]);
@@ -1386,12 +1679,245 @@ static float probe_pt(float x, float y, float z_before) {
   
   SERIAL_PROTOCOLPGM("] \n");  
 #endif 
+#endif //PROBE_LOG
+
   return probe_z;
 }
 
+#ifdef PROBE_TOUR
+static float probe_hop(const float a[2], const float b[2]) {
+  return sqrt(sq(a[0] - b[0]) + sq(a[1] - b[1]));
+}
+
+// Travel from the bed centre through pts in tour order
+static float probe_tour_length(const float pts[][2], const uint8_t tour[], uint8_t n) {
+  static const float centre[2] = { 0, 0 };
+  float length = 0;
+  for (uint8_t i = 0; i < n; i++)
+    length += probe_hop(i ? pts[tour[i - 1]] : centre, pts[tour[i]]);
+  return length;
+}
+
+// Reorder tour[] into a short open path from the bed centre: nearest
+// neighbour first, then 2-opt until no reversal shortens it.
+static void plan_probe_tour(const float pts[][2], uint8_t tour[], uint8_t n) {
+  static const float centre[2] = { 0, 0 };
+  for (uint8_t i = 0; i < n; i++) {
+    const float *from = i ? pts[tour[i - 1]] : centre;
+    uint8_t best = i;
+    for (uint8_t j = i + 1; j < n; j++)
+      if (probe_hop(from, pts[tour[j]]) < probe_hop(from, pts[tour[best]])) best = j;
+    uint8_t t = tour[i]; tour[i] = tour[best]; tour[best] = t;
+  }
+
+  bool improved;
+  do {
+    improved = false;
+    for (uint8_t i = 0; i + 1 < n; i++) {
+      const float *before = i ? pts[tour[i - 1]] : centre;
+      for (uint8_t j = i + 1; j < n; j++) {
+        // reversing tour[i..j] swaps the edges before i and after j
+        float gain = probe_hop(before, pts[tour[i]]) - probe_hop(before, pts[tour[j]]);
+        if (j + 1 < n)
+          gain += probe_hop(pts[tour[j]], pts[tour[j + 1]]) - probe_hop(pts[tour[i]], pts[tour[j + 1]]);
+        if (gain > 0.01) {
+          for (uint8_t a = i, b = j; a < b; a++, b--) {
+            uint8_t t = tour[a]; tour[a] = tour[b]; tour[b] = t;
+          }
+          improved = true;
+        }
+      }
+    }
+    manage_heater();
+    manage_inactivity();
+  } while (improved);
+}
+
+static void report_probe_tour(uint8_t n, float tour_length, float plain_length) {
+  SERIAL_PROTOCOLPGM("Probe tour: ");
+  SERIAL_PROTOCOL(int(n));
+  SERIAL_PROTOCOLPGM(" points, travel ");
+  SERIAL_PROTOCOL_F(tour_length, 1);
+  SERIAL_PROTOCOLPGM("mm, saved ");
+  SERIAL_PROTOCOL_F(plain_length - tour_length, 1);
+  SERIAL_PROTOCOLLNPGM("mm");
+}
+#endif //PROBE_TOUR
+
+#if defined(AUTO_BED_LEVELING_GRID) && !defined(BED_LEVEL_POLAR)
+// Fill order[] with the grid points to probe (x + y * AUTO_BED_LEVELING_GRID_POINTS) and return
+// their count: a serpentine over the rows, or with PROBE_TOUR a tour planned on the first G29.
+// The polar G29 already goes out from the centre ring by ring, which leaves a tour nothing to save.
+static uint8_t grid_probe_order(uint8_t order[]) {
+  #ifdef PROBE_TOUR
+    static uint8_t grid_tour[AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS];
+    static uint8_t grid_tour_points = 0;
+    static float grid_tour_length, grid_plain_length;
+    if (grid_tour_points) {
+      memcpy(order, grid_tour, grid_tour_points);
+      report_probe_tour(grid_tour_points, grid_tour_length, grid_plain_length);
+      return grid_tour_points;
+    }
+  #endif
+
+  uint8_t n = 0;
+  for (int yCount = 0; yCount < AUTO_BED_LEVELING_GRID_POINTS; yCount++) {
+    for (int i = 0; i < AUTO_BED_LEVELING_GRID_POINTS; i++) {
+      int xCount = (yCount % 2) ? i : AUTO_BED_LEVELING_GRID_POINTS - 1 - i;
+      #ifdef DELTA
+        // Avoid probing the corners (outside the round or hexagon print surface) on a delta printer.
+        float xProbe = LEFT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_X * xCount;
+        float yProbe = FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * yCount;
+        if (sqrt(xProbe*xProbe + yProbe*yProbe) > DELTA_PROBABLE_RADIUS) continue;
+      #endif
+      order[n++] = xCount + yCount * AUTO_BED_LEVELING_GRID_POINTS;
+    }
+  }
+
+  #ifdef PROBE_TOUR
+    float pts[AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS][2];
+    for (uint8_t i = 0; i < n; i++) {
+      pts[i][0] = LEFT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_X * (order[i] % AUTO_BED_LEVELING_GRID_POINTS);
+      pts[i][1] = FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * (order[i] / AUTO_BED_LEVELING_GRID_POINTS);
+      grid_tour[i] = i;
+    }
+    grid_plain_length = probe_tour_length(pts, grid_tour, n);
+    plan_probe_tour(pts, grid_tour, n);
+    grid_tour_length = probe_tour_length(pts, grid_tour, n);
+    // grid_tour held indices into the serpentine; turn them into grid points
+    for (uint8_t i = 0; i < n; i++) grid_tour[i] = order[grid_tour[i]];
+    memcpy(order, grid_tour, n);
+    grid_tour_points = n;
+    report_probe_tour(n, grid_tour_length, grid_plain_length);
+  #endif
+  return n;
+}
+#endif //AUTO_BED_LEVELING_GRID && !BED_LEVEL_POLAR
+
+#ifdef BED_LEVEL_ADAPTIVE
+// The coarse G29 pass probes every other row and column, counted from the centre.
+static bool grid_point_coarse(int x, int y) {
+  const int half = (AUTO_BED_LEVELING_GRID_POINTS - 1) / 2;
+  return (x - half) % 2 == 0 && (y - half) % 2 == 0;
+}
+
+// After the coarse pass: fit a plane to the coarse points, then for each 2x2-cell block between
+// them either mark its points in wanted[] or fill them in from the plane and the residuals at its
+// corners. Points outside every block (the edge rows of a 7 point grid) are always wanted.
+// Returns the number of blocks refined.
+uint8_t refine_bed_level(const uint8_t order[], uint8_t points, bool wanted[], uint8_t *blocks) {
+  const int n = AUTO_BED_LEVELING_GRID_POINTS, first = ((n - 1) / 2) % 2;
+  static const uint8_t edge[4][2] = { {0, 1}, {2, 3}, {0, 2}, {1, 3} };
+  bool reachable[n * n];
+  memset(reachable, false, sizeof(reachable));
+  for (uint8_t i = 0; i < points; i++) reachable[order[i]] = true;
+
+  plane_fit fit;
+  fit.reset();
+  for (int x = first; x < n; x += 2)
+    for (int y = first; y < n; y += 2)
+      if (reachable[x + y * n])
+        fit.add(LEFT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_X * x, FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * y, bed_level[x][y]);
+  double plane[3];
+  bool planar = fit.solve(plane);
+  #define BED_PLANE(x, y) (plane[0] * (LEFT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_X * (x)) \
+                           + plane[1] * (FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * (y)) + plane[2])
+
+  for (int i = 0; i < n * n; i++) wanted[i] = reachable[i] && !grid_point_coarse(i % n, i / n);
+
+  // Blocks to refine, by their lower left corner; filled blocks are done first so that a refined
+  // neighbour still probes the edge they share.
+  bool refine[n][n];
+  uint8_t refined = 0;
+  *blocks = 0;
+  for (int fill = 1; fill >= 0; fill--) {
+    for (int x0 = first; x0 + 2 < n; x0 += 2) {
+      for (int y0 = first; y0 + 2 < n; y0 += 2) {
+        if (fill) {
+          float r[4];
+          bool known[4];
+          uint8_t corners = 0;
+          for (uint8_t c = 0; c < 4; c++) {
+            int cx = x0 + 2 * (c & 1), cy = y0 + 2 * (c >> 1);
+            known[c] = reachable[cx + cy * n];
+            if (known[c]) {
+              r[c] = bed_level[cx][cy] - BED_PLANE(cx, cy);
+              corners++;
+            }
+          }
+          bool refine_block = !planar || corners < 2;
+          for (uint8_t c = 0; c < 4; c++)
+            if (known[c] && fabs(r[c]) > BED_LEVEL_ADAPTIVE_TOLERANCE) refine_block = true;
+          for (uint8_t e = 0; e < 4; e++) {
+            uint8_t a = edge[e][0], b = edge[e][1];
+            float span = 2 * (e < 2 ? AUTO_BED_LEVELING_GRID_X : AUTO_BED_LEVELING_GRID_Y);
+            if (known[a] && known[b] && fabs(r[a] - r[b]) > BED_LEVEL_ADAPTIVE_SLOPE * span) refine_block = true;
+          }
+          refine[x0][y0] = refine_block;
+          (*blocks)++;
+          if (refine_block) {
+            refined++;
+            continue;
+          }
+
+          // Bilinear over the known corners' residuals, on top of the plane
+          for (int i = 0; i <= 2; i++) {
+            for (int j = 0; j <= 2; j++) {
+              if (i % 2 == 0 && j % 2 == 0) continue;  // a corner
+              float sum = 0, weight = 0;
+              for (uint8_t c = 0; c < 4; c++) {
+                if (!known[c]) continue;
+                float w = ((c & 1) ? i : 2 - i) * ((c >> 1) ? j : 2 - j);
+                sum += w * r[c];
+                weight += w;
+              }
+              bed_level[x0 + i][y0 + j] = BED_PLANE(x0 + i, y0 + j) + (weight ? sum / weight : 0);
+              wanted[x0 + i + (y0 + j) * n] = false;
+            }
+          }
+        }
+        else if (refine[x0][y0]) {
+          for (int i = 0; i <= 2; i++)
+            for (int j = 0; j <= 2; j++)
+              if (i % 2 || j % 2) wanted[x0 + i + (y0 + j) * n] = reachable[x0 + i + (y0 + j) * n];
+        }
+      }
+    }
+  }
+  #undef BED_PLANE
+  bed_level_cell_x = -1;
+  return refined;
+}
+#endif //BED_LEVEL_ADAPTIVE
+
 #endif // #ifdef ENABLE_AUTO_BED_LEVELING
 
 #ifdef NONLINEAR_BED_LEVELING
+#ifdef BED_LEVEL_POLAR
+// Print the centre, then one line per ring.
+static void print_bed_level() {
+  SERIAL_PROTOCOL_F(bed_level_center, 2);
+  SERIAL_ECHOLN("");
+  for (int ring = 0; ring < BED_LEVEL_POLAR_RINGS; ring++) {
+    for (int spoke = 0; spoke < BED_LEVEL_POLAR_SPOKES; spoke++) {
+      SERIAL_PROTOCOL_F(bed_level_polar[ring][spoke], 2);
+      SERIAL_PROTOCOLPGM(" ");
+    }
+    SERIAL_ECHOLN("");
+  }
+}
+
+// Reset calibration results to zero.
+static void reset_bed_level() {
+  bed_level_center = 0.0;
+  for (int ring = 0; ring < BED_LEVEL_POLAR_RINGS; ring++) {
+    for (int spoke = 0; spoke < BED_LEVEL_POLAR_SPOKES; spoke++) {
+      bed_level_polar[ring][spoke] = 0.0;
+    }
+  }
+  bed_level_cell_x = -1;
+}
+#else
 static void extrapolate_one_point(int x, int y, int xdir, int ydir) {
   if (bed_level[x][y] != 0.0) {
     return;  // Don't overwrite good values.
@@ -1408,6 +1934,7 @@ static void extrapolate_one_point(int x, int y, int xdir, int ydir) {
     if (a < c) median = a;
   }
   bed_level[x][y] = median;
+  bed_level_cell_x = -1;
 }
 
 // Fill in the unprobed points (corners of circular print surface)
@@ -1436,6 +1963,39 @@ static void print_bed_level() {
   }
 }
 
+#ifdef BED_LEVEL_SUBDIVISION
+// Catmull-Rom spline through p[1] (t = 0) and p[2] (t = 1).
+static float catmull_rom(const float p[4], float t) {
+  return p[1] + 0.5 * t * (p[2] - p[0] + t * (2*p[0] - 5*p[1] + 4*p[2] - p[3] + t * (3*(p[1] - p[2]) + p[3] - p[0])));
+}
+
+// Rebuild bed_level_mesh from bed_level, splitting every cell into
+// bed_level_subdivision x bed_level_subdivision with bicubic interpolation.
+static void subdivide_bed_level() {
+  const int last = AUTO_BED_LEVELING_GRID_POINTS - 1;
+  bed_level_mesh_points = last * bed_level_subdivision + 1;
+  for (int x = 0; x < bed_level_mesh_points; x++) {
+    int cell_x = min(x / bed_level_subdivision, last - 1);
+    float t_x = float(x - cell_x * bed_level_subdivision) / bed_level_subdivision;
+    for (int y = 0; y < bed_level_mesh_points; y++) {
+      int cell_y = min(y / bed_level_subdivision, last - 1);
+      float t_y = float(y - cell_y * bed_level_subdivision) / bed_level_subdivision;
+      float column[4];
+      for (int i = 0; i < 4; i++) {
+        int probe_x = constrain(cell_x + i - 1, 0, last);
+        float row[4];
+        for (int j = 0; j < 4; j++) {
+          row[j] = bed_level[probe_x][constrain(cell_y + j - 1, 0, last)];
+        }
+        column[i] = catmull_rom(row, t_y);
+      }
+      BED_LEVEL_MESH(x, y) = catmull_rom(column, t_x);
+    }
+  }
+  bed_level_cell_x = -1;
+}
+#endif //BED_LEVEL_SUBDIVISION
+
 // Reset calibration results to zero.
 static void reset_bed_level() {
   for (int y = 0; y < AUTO_BED_LEVELING_GRID_POINTS; y++) {
@@ -1443,6 +2003,19 @@ static void reset_bed_level() {
       bed_level[x][y] = 0.0;
     }
   }
+  bed_level_cell_x = -1;
+  #ifdef BED_LEVEL_SUBDIVISION
+    subdivide_bed_level();
+  #endif
+}
+#endif //BED_LEVEL_POLAR
+
+// Call after writing the probed mesh from outside (e.g. EEPROM) so derived data is rebuilt.
+void bed_level_updated() {
+  bed_level_cell_x = -1;
+  #ifdef BED_LEVEL_SUBDIVISION
+    subdivide_bed_level();
+  #endif
 }
 #endif //NONLINEAR_BED_LEVELING
 
@@ -1542,6 +2115,17 @@ void set_default_z_probe_offset()
   z_probe_offset[Z_AXIS] = default_z_probe_offset[Z_AXIS];
   }
 
+// Tower X/Y positions for a delta radius and the tower_adj[] layout of adjustments
+// (angles A/B/C in degrees, then radius offsets A/B/C).
+static void delta_tower_positions(float radius, const float adj[6], float tower_x[3], float tower_y[3])
+{
+  const float angle[3] = { 210, 330, 90 }; // front left, front right, back middle
+  for (int8_t i = 0; i < 3; i++) {
+    tower_x[i] = (radius + adj[3 + i]) * cos((angle[i] + adj[i]) * PI/180);
+    tower_y[i] = (radius + adj[3 + i]) * sin((angle[i] + adj[i]) * PI/180);
+  }
+}
+
 void set_delta_constants()
 {
   max_length[Z_AXIS] = max_pos[Z_AXIS] - Z_MIN_POS;
@@ -1562,12 +2146,18 @@ void set_delta_constants()
   delta_tower3_y = -2 * (-COS_60 * delta_radius);
   */
 
-  delta_tower1_x = (delta_radius + tower_adj[3]) * cos((210 + tower_adj[0]) * PI/180); // front left tower
-  delta_tower1_y = (delta_radius + tower_adj[3]) * sin((210 + tower_adj[0]) * PI/180);
-  delta_tower2_x = (delta_radius + tower_adj[4]) * cos((330 + tower_adj[1]) * PI/180); // front right tower
-  delta_tower2_y = (delta_radius + tower_adj[4]) * sin((330 + tower_adj[1]) * PI/180);
-  delta_tower3_x = (delta_radius + tower_adj[5]) * cos((90 + tower_adj[2]) * PI/180);  // back middle tower
-  delta_tower3_y = (delta_radius + tower_adj[5]) * sin((90 + tower_adj[2]) * PI/180);
+  float tower_x[3], tower_y[3];
+  delta_tower_positions(delta_radius, tower_adj, tower_x, tower_y);
+  delta_tower1_x = tower_x[0]; // front left tower
+  delta_tower1_y = tower_y[0];
+  delta_tower2_x = tower_x[1]; // front right tower
+  delta_tower2_y = tower_y[1];
+  delta_tower3_x = tower_x[2]; // back middle tower
+  delta_tower3_y = tower_y[2];
+
+  #ifdef DELTA_FIXED_POINT_KINEMATICS
+    calculate_delta_steps_init();
+  #endif
 }
 
 void apply_endstop_adjustment(float x_endstop, float y_endstop, float z_endstop)
@@ -1585,6 +2175,13 @@ void apply_endstop_adjustment(float x_endstop, float y_endstop, float z_endstop)
     st_synchronize();
 }
 
+#ifdef AUTOCAL_PIPELINE
+// Whether a G30 reading is within the calibration precision
+static bool ac_level_ok(float level) {
+  return level >= -ac_prec && level <= ac_prec;
+}
+#endif
+
 void adj_endstops() {
   boolean x_done = false;
   boolean y_done = false;
@@ -1593,11 +2190,22 @@ void adj_endstops() {
 
   do
     {
+    #ifdef AUTOCAL_PIPELINE
+      probe_bed_then(-SIN_60 * bed_radius, -COS_60 * bed_radius);
+    #endif
     bed_level_z = probe_bed(0.0, bed_radius);
+    #ifdef AUTOCAL_PIPELINE
+      probe_bed_then(SIN_60 * bed_radius, -COS_60 * bed_radius);
+    #endif
     bed_level_x = probe_bed(-SIN_60 * bed_radius, -COS_60 * bed_radius);
     bed_level_y = probe_bed(SIN_60 * bed_radius, -COS_60 * bed_radius);
 
     apply_endstop_adjustment(bed_level_x, bed_level_y, bed_level_z);
+    #ifdef AUTOCAL_PIPELINE
+      // Back to the Z tower for another round while this one is reported
+      if (!ac_level_ok(bed_level_x) || !ac_level_ok(bed_level_y) || !ac_level_ok(bed_level_z))
+        probe_bed_queue(0.0, bed_radius);
+    #endif
 
     SERIAL_ECHO("x:");
     SERIAL_PROTOCOL_F(bed_level_x, 4);
@@ -2349,78 +2957,18 @@ float z_probe() {
   return mm;
 }
 */
-//Sorting function (Author: Bill Gentles, Nov. 12, 2010)
-void isort(double *a, int n)
-// *a is an array pointer function
-{
-  for (int i = 1; i < n; ++i) {
-double j = a[i];
-int k;
-for (k = i - 1; (k >= 0) && (j < a[k]); k--) {
-      a[k + 1] = a[k];
-    }
-    a[k + 1] = j;
-  }
-}
-
-//Mode function, returning the mode or median
-double probe_mode(double *x,int n){
-  int i = 0;
-  int count = 0;
-  int maxCount = 0;
-  int prevCount = 0;
-  double mode = NULL;
-  int bimodal;
-
-  while(i<(n-1)){
-    count=0;
-    while(x[i]==x[i+1]){
-      count++;
-      i++;
-    }
-    if(count>0 & count>=maxCount){
-      mode=x[i];
-      if(count>maxCount){
-        bimodal=0;
-      }
-      prevCount=maxCount;
-      maxCount=count;
-    }
-    if(count>0 & prevCount==maxCount){//If the dataset has 2 or more modes.
-      bimodal=1;
-    }
-    if(count==0){
-      i++;
-    }
-   }
-   if(mode==NULL||bimodal==1){//Return the median if there is no mode.
-      mode=x[(n/2)];
-   }
-   return mode;
-}
-
 //**PJR - Re-written to use probe_pt(x, y, z) returns measured bed level corrected for probe offset
 float probe_bed(float x, float y)
   {
     float probe_z;
-    //**PJR - Lift the probe if below minimum level (eg sat on bed after a previous probing)
-    if (current_position[Z_AXIS] < (AUTOCAL_PROBELIFT - z_probe_offset[Z_AXIS]))
+    #ifdef PROBE_FLYBY
+    if (!probe_flyby_valid)
+    #endif
     {
-      feedrate = AUTOCAL_TRAVELRATE * 60;
-      destination[X_AXIS] = current_position[X_AXIS];
-      destination[Y_AXIS] = current_position[Y_AXIS];
-      destination[Z_AXIS] = current_position[Z_AXIS] + AUTOCAL_PROBELIFT;
-      prepare_move();
+      probe_bed_travel(x, y);
+      st_synchronize();
     }
 
-    //**PJR - Move to probing point using a delta safe move.
-    feedrate = AUTOCAL_TRAVELRATE * 60;
-    destination[X_AXIS] = x - z_probe_offset[X_AXIS];
-    destination[Y_AXIS] = y - z_probe_offset[Y_AXIS];
-    destination[Z_AXIS] = current_position[Z_AXIS];
-    prepare_move();
-    st_synchronize();
-
     //**PJR - Probe bed at specified location and return z height of bed
     probe_z = probe_pt(x, y, current_position[Z_AXIS]) + z_probe_offset[Z_AXIS];
 
@@ -2443,23 +2991,19 @@ void bed_probe_all()
   prepare_move_raw();
   st_synchronize();
 
-  //Probe all bed positions & store carriage positions
-  bed_level_c = probe_bed(0.0, 0.0);
-  save_carriage_positions(0);
-  //bed_safe_z = bed_level_c + 2;
-  //SERIAL_ECHOPAIR("6.bed_safe_z = ",bed_safe_z);
-  bed_level_z = probe_bed(0.0, bed_radius);
-  save_carriage_positions(1);
-  bed_level_oy = probe_bed(-SIN_60 * bed_radius, COS_60 * bed_radius);
-  save_carriage_positions(2);
-  bed_level_x = probe_bed(-SIN_60 * bed_radius, -COS_60 * bed_radius);
-  save_carriage_positions(3);
-  bed_level_oz = probe_bed(0.0, -bed_radius);
-  save_carriage_positions(4);
-  bed_level_y = probe_bed(SIN_60 * bed_radius, -COS_60 * bed_radius);
-  save_carriage_positions(5);
-  bed_level_ox = probe_bed(SIN_60 * bed_radius, COS_60 * bed_radius);
-  save_carriage_positions(6);
+  //Probe all bed positions & store carriage positions: the centre, then round from the Z tower
+  const float point[7][2] = {
+    { 0.0, 0.0 }, { 0.0, bed_radius }, { float(-SIN_60 * bed_radius), float(COS_60 * bed_radius) },
+    { float(-SIN_60 * bed_radius), float(-COS_60 * bed_radius) }, { 0.0, -bed_radius },
+    { float(SIN_60 * bed_radius), float(-COS_60 * bed_radius) }, { float(SIN_60 * bed_radius), float(COS_60 * bed_radius) } };
+  float *level[7] = { &bed_level_c, &bed_level_z, &bed_level_oy, &bed_level_x, &bed_level_oz, &bed_level_y, &bed_level_ox };
+  for (int i = 0; i < 7; i++) {
+    #ifdef AUTOCAL_PIPELINE
+      if (i < 6) probe_bed_then(point[i + 1][0], point[i + 1][1]);
+    #endif
+    *level[i] = probe_bed(point[i][0], point[i][1]);
+    save_carriage_positions(i);
+  }
   }
 
 void calibration_report()
@@ -2523,6 +3067,9 @@ void save_carriage_positions(int position_num) {
 }
 
 void home_delta_axis() {
+    #ifdef PROBE_FLYBY
+      probe_flyby_valid = false; // the nozzle is no longer near the bed
+    #endif
     saved_feedrate = feedrate;
     saved_feedmultiply = feedmultiply;
     feedmultiply = 100;
@@ -2570,6 +3117,152 @@ void home_delta_axis() {
     endstops_hit_on_purpose();
 }
 
+#ifdef DELTA_LEAST_SQUARES_CALIBRATION
+// Least squares delta calibration. Each point is probed once and its carriage heights kept; the
+// geometry changes p are then fitted so that the nozzle would have touched a flat bed at Z=0:
+//   p[0..2] endstop offsets, p[3] delta radius, p[4..5] tower A/B angles, p[6] diagonal rod.
+// Tower C stays put since turning all three towers together does not change the bed shape.
+
+// Height the nozzle would have had at carriage heights h with geometry changes p applied.
+// The trial geometry is built locally; the machine's own stays as it is.
+static float lsq_model_z(const float h[3], const float p[7], int factors)
+{
+  float adj[6], tower_x[3], tower_y[3], rod_2[3];
+  for (int8_t i = 0; i < 6; i++) adj[i] = tower_adj[i];
+  if (factors > 4) adj[0] += p[4];
+  if (factors > 5) adj[1] += p[5];
+  delta_tower_positions(delta_radius + (factors > 3 ? p[3] : 0), adj, tower_x, tower_y);
+  float rod = delta_diagonal_rod + (factors > 6 ? p[6] : 0);
+  for (int8_t i = 0; i < 3; i++) rod_2[i] = sq(rod + diagrod_adj[i]);
+
+  // Raising an endstop offset lowers the carriage for the same step count
+  float carriage[3], cartesian[3];
+  for (int8_t i = 0; i < 3; i++) carriage[i] = h[i] - p[i];
+  calculate_cartesian(carriage, cartesian, tower_x, tower_y, rod_2);
+  return cartesian[Z_AXIS];
+}
+
+static float lsq_rms(const float *z, int n)
+{
+  float sum = 0;
+  for (int k = 0; k < n; k++) sum += z[k] * z[k];
+  return sqrt(sum / n);
+}
+
+// Fit the geometry changes p[0..factors-1] (the rest are zeroed) to m points probed at
+// carriage heights carriage[k], where the bed was found at probe_z[k]. Works on the
+// current geometry without changing it. Returns the RMS deviation the fit leaves.
+float delta_lsq_fit(const float carriage[][3], const float probe_z[], int m, int factors, float p[7])
+{
+  float residual[DELTA_CALIBRATION_POINTS];
+  float model_z0[DELTA_CALIBRATION_POINTS];
+  double eqnAMatrix[DELTA_CALIBRATION_POINTS * 7];
+  double eqnBVector[DELTA_CALIBRATION_POINTS];
+  const float h = 0.1; // finite difference step, mm or degrees
+
+  for (int j = 0; j < 7; j++) p[j] = 0;
+  for (int k = 0; k < m; k++) model_z0[k] = lsq_model_z(carriage[k], p, factors);
+
+  for (int iteration = 0; iteration < DELTA_CALIBRATION_ITERATIONS; iteration++) {
+    for (int k = 0; k < m; k++) {
+      float z = lsq_model_z(carriage[k], p, factors);
+      residual[k] = probe_z[k] + z - model_z0[k];
+      for (int j = 0; j < factors; j++) {
+        p[j] += h;
+        eqnAMatrix[k + j * m] = (lsq_model_z(carriage[k], p, factors) - z) / h;
+        p[j] -= h;
+      }
+      eqnBVector[k] = -residual[k];
+      manage_heater();
+      manage_inactivity();
+    }
+    double *step = qr_solve(m, factors, eqnAMatrix, eqnBVector);
+    for (int j = 0; j < factors; j++) p[j] += step[j];
+    free(step);
+  }
+  for (int k = 0; k < m; k++)
+    residual[k] = probe_z[k] + lsq_model_z(carriage[k], p, factors) - model_z0[k];
+  return lsq_rms(residual, m);
+}
+
+// Probe the calibration points, then fit and apply the geometry. Returns the probed RMS deviation.
+static float delta_lsq_calibrate(int factors)
+{
+  const int m = DELTA_CALIBRATION_POINTS;
+  float probe_z[DELTA_CALIBRATION_POINTS];
+  float carriage[DELTA_CALIBRATION_POINTS][3];
+
+  feedrate = AUTOCAL_TRAVELRATE * 60;
+  destination[Z_AXIS] = bed_safe_z;
+  prepare_move_raw();
+  st_synchronize();
+
+  // centre, outer ring through the towers, inner ring between them
+  float pts[DELTA_CALIBRATION_POINTS][2];
+  for (int k = 0; k < m; k++) {
+    pts[k][0] = pts[k][1] = 0;
+    if (k > 0) {
+      float r = k <= 6 ? bed_radius : bed_radius / 2;
+      float angle = (k <= 6 ? 90 + (k - 1) * 60 : 120 + (k - 7) * 60) * PI / 180;
+      pts[k][0] = r * cos(angle);
+      pts[k][1] = r * sin(angle);
+    }
+  }
+
+  #ifdef PROBE_TOUR
+    static uint8_t tour[DELTA_CALIBRATION_POINTS];
+    static float tour_length = 0, plain_length;
+    if (tour_length == 0) {
+      for (int k = 0; k < m; k++) tour[k] = k;
+      plain_length = probe_tour_length(pts, tour, m);
+      plan_probe_tour(pts, tour, m);
+      tour_length = probe_tour_length(pts, tour, m);
+    }
+    report_probe_tour(m, tour_length, plain_length);
+  #endif
+
+  for (int t = 0; t < m; t++) {
+    #ifdef PROBE_TOUR
+      int k = tour[t];
+    #else
+      int k = t;
+    #endif
+    probe_z[k] = probe_bed(pts[k][0], pts[k][1]);
+    for (int8_t i = 0; i < 3; i++) carriage[k][i] = saved_position[i];
+  }
+
+  float rms = lsq_rms(probe_z, m);
+  SERIAL_ECHOPGM("Probed deviation RMS: ");
+  SERIAL_PROTOCOL_F(rms, 4);
+  SERIAL_ECHOLN("");
+  if (rms <= ac_prec) return rms;
+
+  float p[7];
+  float expected = delta_lsq_fit(carriage, probe_z, m, factors, p);
+  SERIAL_ECHOPGM("Expected deviation RMS: ");
+  SERIAL_PROTOCOL_F(expected, 4);
+  SERIAL_ECHOLN("");
+
+  // Keep the endstop offsets at or below zero (homing only backs off from the switch)
+  // and move the homed height with them instead.
+  for (int8_t i = 0; i < 3; i++) endstop_adj[i] += p[i];
+  float highest = max(endstop_adj[X_AXIS], max(endstop_adj[Y_AXIS], endstop_adj[Z_AXIS]));
+  if (highest > 0) {
+    for (int8_t i = 0; i < 3; i++) endstop_adj[i] -= highest;
+    max_pos[Z_AXIS] -= highest;
+  }
+  if (factors > 3) delta_radius += p[3];
+  if (factors > 4) tower_adj[0] += p[4];
+  if (factors > 5) tower_adj[1] += p[5];
+  if (factors > 6) delta_diagonal_rod += p[6];
+  set_delta_constants();
+
+  home_delta_axis();
+  bed_safe_z = AUTOCAL_PROBELIFT - z_probe_offset[Z_AXIS];
+  return rms;
+}
+#endif //DELTA_LEAST_SQUARES_CALIBRATION
+
 void refresh_cmd_timeout(void)
 {
   previous_millis_cmd = millis();
@@ -2747,7 +3440,7 @@ void process_commands()
       plan_bed_level_matrix.set_to_identity();  //Reset the plane ("erase" all leveling data)
 #endif //ENABLE_AUTO_BED_LEVELING
 
-#ifdef NONLINEAR_BED_LEVELING
+#if defined(NONLINEAR_BED_LEVELING) && !defined(BED_LEVEL_EEPROM)
       reset_bed_level();
 #endif //NONLINEAR_BED_LEVELING
 
@@ -2992,6 +3685,25 @@ void process_commands()
                 break; // abort G29, since we don't know where we are
             }
 
+            #ifdef PROBE_FLYBY
+              probe_flyby_reset();
+            #endif
+            #ifdef PROBE_LOG
+              probe_log_begin();
+            #endif
+
+          #ifdef BED_LEVEL_SUBDIVISION
+            if (code_seen('S')) {
+              int subdivision = code_value();
+              if (subdivision < 1 || (AUTO_BED_LEVELING_GRID_POINTS - 1) * subdivision + 1 > BED_LEVEL_MESH_MAX_POINTS) {
+                SERIAL_ERROR_START;
+                SERIAL_ERRORLNPGM("G29 S does not fit in BED_LEVEL_MESH_MAX_POINTS");
+                break;
+              }
+              bed_level_subdivision = subdivision;
+            }
+          #endif //BED_LEVEL_SUBDIVISION
+
 #ifdef Z_PROBE_SLED
             dock_sled(false);
 #endif // Z_PROBE_SLED
@@ -3026,10 +3738,11 @@ void process_commands()
             // the normal vector to the plane is formed by the coefficients of the plane equation in the standard form, which is Vx*x+Vy*y+Vz*z+d = 0
             // so Vx = -a Vy = -b Vz = 1 (we want the vector facing towards positive Z
 
-            // "A" matrix of the linear system of equations
-            double eqnAMatrix[AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS*3];
-            // "B" vector of Z points
-            double eqnBVector[AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS];
+          #ifndef NONLINEAR_BED_LEVELING
+            // accumulates the normal equations as each point is probed
+            plane_fit bed_plane;
+            bed_plane.reset();
+          #endif
 
             #ifdef NONLINEAR_BED_LEVELING
             float z_offset = Z_PROBE_OFFSET_FROM_EXTRUDER;
@@ -3038,26 +3751,59 @@ void process_commands()
             }
             #endif //NONLINEAR_BED_LEVELING
 
-            int probePointCounter = 0;
-            for (int yCount=0; yCount < AUTO_BED_LEVELING_GRID_POINTS; yCount++)
+          #ifdef BED_LEVEL_POLAR
+            // Probe the centre, then ring by ring. Rings alternate direction so
+            // each one starts next to where the previous one ended.
+            for (int ring = 0; ring <= BED_LEVEL_POLAR_RINGS; ring++)
             {
-              float yProbe = FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * yCount;
-              int xStart, xStop, xInc;
-              if (yCount % 2) {
-                xStart = 0;
-                xStop = AUTO_BED_LEVELING_GRID_POINTS;
-                xInc = 1;
-              } else {
-                xStart = AUTO_BED_LEVELING_GRID_POINTS - 1;
-                xStop = -1;
-                xInc = -1;
-              }
-
-              for (int xCount=xStart; xCount != xStop; xCount += xInc)
+              float radius = DELTA_PROBABLE_RADIUS * ring / BED_LEVEL_POLAR_RINGS;
+              int spokes = ring ? BED_LEVEL_POLAR_SPOKES : 1;
+              for (int i = 0; i < spokes; i++)
               {
+                int spoke = (ring % 2) ? i : spokes - 1 - i;
+                float angle = spoke * (2 * PI / BED_LEVEL_POLAR_SPOKES);
+                float z_before = ring ? current_position[Z_AXIS] + Z_RAISE_BETWEEN_PROBINGS : Z_RAISE_BEFORE_PROBING;
+
+                float measured_z = probe_pt(radius * cos(angle), radius * sin(angle), z_before);
+
+                if (ring)
+                  bed_level_polar[ring - 1][spoke] = measured_z + z_offset;
+                else
+                  bed_level_center = measured_z + z_offset;
+                bed_level_cell_x = -1;
+
+                manage_heater();
+                manage_inactivity();
+                lcd_update();
+              }
+            }
+            clean_up_after_endstop_move();
+            print_bed_level();
+          #else
+            uint8_t probe_order[AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS];
+            uint8_t probe_points = grid_probe_order(probe_order);
+            int probed = 0;
+          #ifdef BED_LEVEL_ADAPTIVE
+            // Pass 0 probes the coarse points, pass 1 whatever refine_bed_level() asks for
+            bool probe_wanted[AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS];
+            uint8_t blocks_refined = 0, blocks = 0;
+            for (int i = 0; i < AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS; i++)
+              probe_wanted[i] = grid_point_coarse(i % AUTO_BED_LEVELING_GRID_POINTS, i / AUTO_BED_LEVELING_GRID_POINTS);
+            for (int pass = 0; pass < 2; pass++)
+            {
+            if (pass) blocks_refined = refine_bed_level(probe_order, probe_points, probe_wanted, &blocks);
+          #endif
+            for (int probePointCounter = 0; probePointCounter < probe_points; probePointCounter++)
+            {
+              #ifdef BED_LEVEL_ADAPTIVE
+                if (!probe_wanted[probe_order[probePointCounter]]) continue;
+              #endif
+                int xCount = probe_order[probePointCounter] % AUTO_BED_LEVELING_GRID_POINTS;
+                int yCount = probe_order[probePointCounter] / AUTO_BED_LEVELING_GRID_POINTS;
                 float xProbe = LEFT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_X * xCount;
+                float yProbe = FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * yCount;
                 float z_before;
-                if (probePointCounter == 0)
+                if (probed++ == 0)
                 {
                   // raise before probing
                   z_before = Z_RAISE_BEFORE_PROBING;
@@ -3067,61 +3813,64 @@ void process_commands()
                   z_before = current_position[Z_AXIS] + Z_RAISE_BETWEEN_PROBINGS;
                 }
 
-                #ifdef DELTA
-                // Avoid probing the corners (outside the round or hexagon print surface) on a delta printer.
-                float distance_from_center = sqrt(xProbe*xProbe + yProbe*yProbe);
-               /* SERIAL_PROTOCOLPGM("DELTA_RADIUS: ");
-                SERIAL_PROTOCOL(DELTA_PROBABLE_RADIUS);
-                SERIAL_PROTOCOLPGM("  X: ");
-                SERIAL_PROTOCOL(xProbe);
-                SERIAL_PROTOCOLPGM(" Y: ");
-                SERIAL_PROTOCOL(yProbe);
-                SERIAL_PROTOCOLPGM(" DIST: ");
-                SERIAL_PROTOCOLLN(distance_from_center); */
-                if (distance_from_center > DELTA_PROBABLE_RADIUS) continue;
-                
-                #endif //DELTA
-
                 float measured_z = probe_pt(xProbe, yProbe, z_before);
 
                 #ifdef NONLINEAR_BED_LEVELING
                 // @todo: take x and y offset into account
                 bed_level[xCount][yCount] = measured_z + z_offset;
+                bed_level_cell_x = -1;
                 #endif //NONLINEAR_BED_LEVELING
 
-                eqnBVector[probePointCounter] = measured_z;
-
-                eqnAMatrix[probePointCounter + 0*AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS] = xProbe;
-                eqnAMatrix[probePointCounter + 1*AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS] = yProbe;
-                eqnAMatrix[probePointCounter + 2*AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS] = 1;
-                probePointCounter++;
+                #ifndef NONLINEAR_BED_LEVELING
+                bed_plane.add(xProbe, yProbe, measured_z);
+                #endif
 
                 manage_heater();
                 manage_inactivity();
                 lcd_update();
-              }
             }
+          #ifdef BED_LEVEL_ADAPTIVE
+            }
+            SERIAL_PROTOCOLPGM("Adaptive G29: probed ");
+            SERIAL_PROTOCOL(probed);
+            SERIAL_PROTOCOLPGM(" of ");
+            SERIAL_PROTOCOL(int(probe_points));
+            SERIAL_PROTOCOLPGM(" points, refined ");
+            SERIAL_PROTOCOL(int(blocks_refined));
+            SERIAL_PROTOCOLPGM(" of ");
+            SERIAL_PROTOCOL(int(blocks));
+            SERIAL_PROTOCOLLNPGM(" blocks");
+          #endif
             clean_up_after_endstop_move();
 
           #ifdef NONLINEAR_BED_LEVELING
             extrapolate_unprobed_bed_level();
             print_bed_level();
+            #ifdef BED_LEVEL_SUBDIVISION
+              subdivide_bed_level();
+              SERIAL_PROTOCOLPGM("Mesh ");
+              SERIAL_PROTOCOL(int(bed_level_mesh_points));
+              SERIAL_PROTOCOLPGM("x");
+              SERIAL_PROTOCOLLN(int(bed_level_mesh_points));
+            #endif
           #else //NONLINEAR_BED_LEVELING
             // solve lsq problem
-            double *plane_equation_coefficients = qr_solve(AUTO_BED_LEVELING_GRID_POINTS*AUTO_BED_LEVELING_GRID_POINTS, 3, eqnAMatrix, eqnBVector);
-
-            SERIAL_PROTOCOLPGM("Eqn coefficients: a: ");
-            SERIAL_PROTOCOL(plane_equation_coefficients[0]);
-            SERIAL_PROTOCOLPGM(" b: ");
-            SERIAL_PROTOCOL(plane_equation_coefficients[1]);
-            SERIAL_PROTOCOLPGM(" d: ");
-            SERIAL_PROTOCOLLN(plane_equation_coefficients[2]);
-
-
-            set_bed_level_equation_lsq(plane_equation_coefficients);
-
-            free(plane_equation_coefficients);
+            double plane_equation_coefficients[3];
+            if (bed_plane.solve(plane_equation_coefficients)) {
+              SERIAL_PROTOCOLPGM("Eqn coefficients: a: ");
+              SERIAL_PROTOCOL(plane_equation_coefficients[0]);
+              SERIAL_PROTOCOLPGM(" b: ");
+              SERIAL_PROTOCOL(plane_equation_coefficients[1]);
+              SERIAL_PROTOCOLPGM(" d: ");
+              SERIAL_PROTOCOLLN(plane_equation_coefficients[2]);
+
+              set_bed_level_equation_lsq(plane_equation_coefficients);
+            } else {
+              SERIAL_ERROR_START;
+              SERIAL_ERRORLNPGM("Probed points do not span a plane");
+            }
           #endif //NONLINEAR_BED_LEVELING
+          #endif //BED_LEVEL_POLAR
 
 #else // AUTO_BED_LEVELING_GRID not defined
 
@@ -3142,6 +3891,9 @@ void process_commands()
 
 #endif // AUTO_BED_LEVELING_GRID
             st_synchronize();
+          #ifdef PROBE_LOG
+            probe_log_summary();
+          #endif
 
           #ifndef SERVO_ENDSTOPS
             retract_z_probe();   // Retract Z probe by moving the end effector.
@@ -3183,6 +3935,10 @@ void process_commands()
             break; // abort G30, since we don't know where we are
         }
 
+        #ifdef PROBE_FLYBY
+          probe_flyby_reset();
+        #endif
+
 
         st_synchronize();
         // make sure the bed_level_rotation_matrix is identity or the planner will get it incorectly
@@ -3248,6 +4004,9 @@ void process_commands()
        saved_feedrate = feedrate;
        saved_feedmultiply = feedmultiply;
        feedmultiply = 100;
+       #ifdef PROBE_LOG
+         probe_log_begin();
+       #endif
 
        if (code_seen('A'))
          {
@@ -3263,6 +4022,44 @@ void process_commands()
        engage_z_probe();
        bed_safe_z = current_position[Z_AXIS]; //20; // **PJR - Since we are at a safe Z height after engaging the probe
 
+       #ifdef DELTA_LEAST_SQUARES_CALIBRATION
+       if (code_seen('L'))
+         {
+         int factors = code_value() >= 3 ? min(int(code_value()), 7) : 6;
+         int passes = code_seen('P') && code_value() >= 1 ? int(code_value()) : 2;
+         SERIAL_ECHO("Least squares calibration, factors: ");
+         SERIAL_ECHOLN(factors);
+         int pass = 0;
+         do {
+            pass ++;
+            SERIAL_ECHO("Pass: ");
+            SERIAL_ECHOLN(pass);
+            } while (delta_lsq_calibrate(factors) > ac_prec && pass < passes);
+
+         SERIAL_ECHOPAIR("Endstop Offsets X:", endstop_adj[X_AXIS]);
+         SERIAL_ECHOPAIR(" Y:", endstop_adj[Y_AXIS]);
+         SERIAL_ECHOPAIR(" Z:", endstop_adj[Z_AXIS]);
+         SERIAL_ECHOLN("");
+         SERIAL_ECHOPAIR("Tower Offsets A:", tower_adj[0]);
+         SERIAL_ECHOPAIR(" b:", tower_adj[1]);
+         SERIAL_ECHOLN("");
+         SERIAL_ECHOPGM("Delta Radius: ");
+         SERIAL_PROTOCOL_F(delta_radius, 4);
+         SERIAL_ECHOPGM(" Diagonal Rod: ");
+         SERIAL_PROTOCOL_F(delta_diagonal_rod, 4);
+         SERIAL_ECHOPGM(" Z Height: ");
+         SERIAL_PROTOCOL_F(max_pos[Z_AXIS], 4);
+         SERIAL_ECHOLN("");
+         #ifdef PROBE_LOG
+           probe_log_summary();
+         #endif
+         retract_z_probe();
+         feedrate = saved_feedrate;
+         feedmultiply = saved_feedmultiply;
+         break;
+         }
+       #endif
+
        //Probe all points
        bed_probe_all();
 
@@ -3282,6 +4079,11 @@ void process_commands()
             adj_endstops();
 
             bed_probe_all();
+            #ifdef AUTOCAL_PIPELINE
+              // Another round starts at the Z tower; go there while the report prints
+              if (!ac_level_ok(bed_level_x) || !ac_level_ok(bed_level_y) || !ac_level_ok(bed_level_z))
+                probe_bed_queue(0.0, bed_radius);
+            #endif
             calibration_report();
             } while ((bed_level_x < -ac_prec) or (bed_level_x > ac_prec)
                       or (bed_level_y < -ac_prec) or (bed_level_y > ac_prec)
@@ -3304,6 +4106,14 @@ void process_commands()
             adj_endstops();
 
             bed_probe_all();
+            #ifdef AUTOCAL_PIPELINE
+              // Another round starts at the Z tower, unless adj_deltaradius() is about to change
+              // the geometry (centre off by more than ac_prec/2): a move queued before that would
+              // end somewhere else than where the new geometry puts it
+              if (fabs(bed_level_c) <= ac_prec/2
+                  && (!ac_level_ok(bed_level_x) || !ac_level_ok(bed_level_y) || !ac_level_ok(bed_level_z)))
+                probe_bed_queue(0.0, bed_radius);
+            #endif
             calibration_report();
 
             SERIAL_ECHOLN("Checking delta radius");
@@ -3354,6 +4164,12 @@ void process_commands()
                adj_endstops();
 
                bed_probe_all();
+               #ifdef AUTOCAL_PIPELINE
+                 if (!ac_level_ok(bed_level_c))
+                   probe_bed_queue(0.0, 0.0);
+                 else if (!ac_level_ok(bed_level_x) || !ac_level_ok(bed_level_y) || !ac_level_ok(bed_level_z))
+                   probe_bed_queue(0.0, bed_radius);
+               #endif
                calibration_report();
 
                if ((bed_level_c < -ac_prec) or (bed_level_c > ac_prec))
@@ -3407,6 +4223,9 @@ void process_commands()
          SERIAL_ECHOLN("Autocalibration Complete");
          }
 
+       #ifdef PROBE_LOG
+         probe_log_summary();
+       #endif
   	retract_z_probe();
 
         //Restore saved variables
@@ -3723,13 +4542,16 @@ void process_commands()
         #endif //NONLINEAR_BED_LEVELING
 
 
-	double sum=0.0;
-	double mean=0.0;
-	double sigma=0.0;
-	double sample_set[50];
-	int verbose_level=1, n=0, j, n_samples = 10, n_legs=0, engage_probe_for_each_reading=0 ;
+	probe_stats stats;
+	int verbose_level=1, n=0, n_samples = 10, n_legs=0, engage_probe_for_each_reading=0 ;
 	double X_current, Y_current, Z_current;
 	double X_probe_location, Y_probe_location, Z_start_location, ext_position;
+	unsigned long sample_millis;
+	unsigned long approach_ms, approach_total, lift_ms, lift_total;
+	#ifdef PROBE_SETTLE_MONITOR
+	unsigned long settle_ms, settle_total, settle_max;
+	int settle_timeouts;
+	#endif
 
 	if (code_seen('V') || code_seen('v')) {
         	verbose_level = code_value();
@@ -3746,7 +4568,7 @@ void process_commands()
 
 	if (code_seen('J') || code_seen('j')) {
         	n_samples = code_value();
-		if (n_samples<4 || n_samples>50 ) {
+		if (n_samples<4 || n_samples>M48_MAX_SAMPLES ) {
 			SERIAL_PROTOCOLPGM("?Specified sample size not plausible.\n");
 			goto Sigma_Exit;
 		}
@@ -3817,11 +4639,16 @@ void process_commands()
 //
 
 	setup_for_endstop_move();
+	#ifdef PROBE_TWO_SPEED
+	run_z_probe(probe_fast_feedrate);
+	#else
 	run_z_probe();
+	#endif
 
 	// **PJR - run_z_probe() sets current_position[Z_AXIS]
 	Z_current = current_position[Z_AXIS]; // = Z_current = st_get_position_mm(Z_AXIS);
-	Z_start_location = Z_current + Z_RAISE_BETWEEN_PROBINGS;  //st_get_position_mm(Z_AXIS) + Z_RAISE_BEFORE_PROBING;
+	// Legs travel across the bed, so they keep the full clearance
+	Z_start_location = Z_current + (n_legs ? Z_RAISE_BETWEEN_PROBINGS : PROBE_SAMPLE_LIFT);  //st_get_position_mm(Z_AXIS) + Z_RAISE_BEFORE_PROBING;
 
 	// **PJR - Raise the probe - is Z only so delta safe
 	do_blocking_move_to(X_current, Y_current, Z_start_location);
@@ -3831,6 +4658,13 @@ void process_commands()
         	retract_z_probe();
 			}
 
+    stats.reset();
+    approach_total = lift_total = 0;
+    sample_millis = millis();
+    #ifdef PROBE_SETTLE_MONITOR
+    settle_total = settle_max = 0;
+    settle_timeouts = 0;
+    #endif
     for( n=0; n<n_samples; n++) {
 
           do_blocking_move_cartesian( X_probe_location, Y_probe_location, Z_start_location); // Make sure we are at the probe location and lift the probe if needed
@@ -3898,29 +4732,12 @@ void process_commands()
                 }
 
 		setup_for_endstop_move();
+		approach_ms = millis();
                 run_z_probe();
+		approach_ms = millis() - approach_ms;
+		approach_total += approach_ms;
 
-		sample_set[n] = current_position[Z_AXIS]; // **PJR - This s the probe position at bed level - NOT corrected for Z_probe offset
-              
-
-//
-// Get the current mean for the data points we have so far
-//
-		sum=0.0;
-		for( j=0; j<=n; j++) {
-			sum = sum + sample_set[j];
-		}
-		mean = sum / (double (n+1));
-//
-// Now, use that mean to calculate the standard deviation for the
-// data points we have so far
-//
-
-		sum=0.0;
-		for( j=0; j<=n; j++) {
-			sum = sum + (sample_set[j]-mean) * (sample_set[j]-mean);
-		}
-		sigma = sqrt( sum / (double (n+1)) );
+		stats.add(current_position[Z_AXIS]); // **PJR - This s the probe position at bed level - NOT corrected for Z_probe offset
 
 		if (verbose_level > 1) {
 			SERIAL_PROTOCOL(n+1);
@@ -3932,18 +4749,42 @@ void process_commands()
 
 		if (verbose_level > 2) {
 			SERIAL_PROTOCOL(" mean: ");
-			SERIAL_PROTOCOL_F(mean,6);
+			SERIAL_PROTOCOL_F(stats.mean,6);
 
 			SERIAL_PROTOCOL("   sigma: ");
-			SERIAL_PROTOCOL_F(sigma,6);
+			SERIAL_PROTOCOL_F(stats.sigma(),6);
 		}
 
-		if (verbose_level > 0)
-			SERIAL_PROTOCOLPGM("\n");
-
 		// **PJR - Lift the probe again (raw move is OK since Z only)
+        lift_ms = millis();
         do_blocking_move_to(X_probe_location, Y_probe_location, Z_start_location);
+        lift_ms = millis() - lift_ms;
+        lift_total += lift_ms;
+        #ifdef PROBE_SETTLE_MONITOR
+        settle_ms = probe_wait_for_release();  //Give FSR time to reset avoid bounce
+        settle_total += settle_ms;
+        settle_max = max(settle_max, settle_ms);
+        if (settle_ms >= PROBE_SETTLE_TIMEOUT) settle_timeouts++;
+        #else
         delay(500);  //Give FSR time to reset avoid bounce
+        #endif
+
+		// Time from the start of the approach to the trigger, the lift, and (with the settle
+		// monitor) from the end of the lift until the FSR reads released
+		if (verbose_level > 1) {
+			SERIAL_PROTOCOLPGM("   approach: ");
+			SERIAL_PROTOCOL(approach_ms);
+			SERIAL_PROTOCOLPGM(" lift: ");
+			SERIAL_PROTOCOL(lift_ms);
+			#ifdef PROBE_SETTLE_MONITOR
+			SERIAL_PROTOCOLPGM(" settle: ");
+			SERIAL_PROTOCOL(settle_ms);
+			#endif
+			SERIAL_PROTOCOLPGM(" ms");
+		}
+
+		if (verbose_level > 0)
+			SERIAL_PROTOCOLPGM("\n");
 
 		if (engage_probe_for_each_reading)  {
         		retract_z_probe();
@@ -3951,6 +4792,8 @@ void process_commands()
 		}
 	}
 
+        sample_millis = (millis() - sample_millis) / n_samples;
+
         retract_z_probe();
         delay(1000);
 
@@ -3965,25 +4808,45 @@ void process_commands()
 	SERIAL_PROTOCOLPGM(",");
         SERIAL_PROTOCOL_F(n_legs, 6);
 	SERIAL_PROTOCOLPGM(",");
-        SERIAL_PROTOCOL_F(mean, 6);
+        SERIAL_PROTOCOL_F(stats.mean, 6);
 	SERIAL_PROTOCOLPGM(",");
-        isort(sample_set,n_samples);
-        //SERIAL_PROTOCOLPGM("Median: ");
-        SERIAL_PROTOCOL_F(sample_set[(n_samples/2)], 6);
+        //SERIAL_PROTOCOLPGM("Median: "); (median and mode are histogram estimates)
+        SERIAL_PROTOCOL_F(stats.median(), 6);
         SERIAL_PROTOCOLPGM(",");
         //SERIAL_PROTOCOLPGM("Mode: ");
-        SERIAL_PROTOCOL_F(probe_mode(sample_set, n_samples), 6);
+        SERIAL_PROTOCOL_F(stats.mode(), 6);
         SERIAL_PROTOCOLPGM(",");
         //SERIAL_PROTOCOLPGM("Range: ");
-        SERIAL_PROTOCOL_F(sample_set[0], 6);
+        SERIAL_PROTOCOL_F(stats.low, 6);
         SERIAL_PROTOCOLPGM(",");
-        SERIAL_PROTOCOL_F(sample_set[(n_samples-1)], 6);
+        SERIAL_PROTOCOL_F(stats.high, 6);
         SERIAL_PROTOCOLPGM(",");
         
         //SERIAL_PROTOCOLPGM("Standard Deviation: ");
-        SERIAL_PROTOCOL_F(sigma, 6);
+        SERIAL_PROTOCOL_F(stats.sigma(), 6);
         SERIAL_PROTOCOLPGM("\n");
 
+        SERIAL_PROTOCOLPGM("Spread: ");
+        SERIAL_PROTOCOL_F(stats.high - stats.low, 6);
+        SERIAL_PROTOCOLPGM(" Time per sample: ");
+        SERIAL_PROTOCOL(sample_millis);
+        SERIAL_PROTOCOLPGM(" ms approach: ");
+        SERIAL_PROTOCOL(approach_total / n_samples);
+        SERIAL_PROTOCOLPGM(" ms lift: ");
+        SERIAL_PROTOCOL(lift_total / n_samples);
+        SERIAL_PROTOCOLPGM(" ms\n");
+        if (verbose_level > 0)
+          stats.report_histogram();
+        #ifdef PROBE_SETTLE_MONITOR
+        SERIAL_PROTOCOLPGM("FSR settle mean: ");
+        SERIAL_PROTOCOL(settle_total / n_samples);
+        SERIAL_PROTOCOLPGM(" ms max: ");
+        SERIAL_PROTOCOL(settle_max);
+        SERIAL_PROTOCOLPGM(" ms timeouts: ");
+        SERIAL_PROTOCOL(settle_timeouts);
+        SERIAL_PROTOCOLPGM("\n");
+        #endif
+
 
 
 Sigma_Exit:
@@ -4356,6 +5219,9 @@ Sigma_Exit:
           }
         }
       }
+      #ifdef DELTA_FIXED_POINT_KINEMATICS
+        calculate_delta_steps_init();
+      #endif
       break;
     case 115: // M115
       SERIAL_PROTOCOLPGM(MSG_M115_REPORT);
@@ -4384,6 +5250,20 @@ Sigma_Exit:
       SERIAL_PROTOCOL(float(st_get_position(Z_AXIS))/axis_steps_per_unit[Z_AXIS]);
 
       SERIAL_PROTOCOLLN("");
+#ifdef DELTA
+      if (code_seen('R')) {
+        // Real effector position from the stepper counts, even mid-move.
+        float real_position[3];
+        get_cartesian_from_steppers(real_position);
+        SERIAL_PROTOCOLPGM("Real X:");
+        SERIAL_PROTOCOL_F(real_position[X_AXIS], 3);
+        SERIAL_PROTOCOLPGM(" Y:");
+        SERIAL_PROTOCOL_F(real_position[Y_AXIS], 3);
+        SERIAL_PROTOCOLPGM(" Z:");
+        SERIAL_PROTOCOL_F(real_position[Z_AXIS], 3);
+        SERIAL_PROTOCOLLN("");
+      }
+#endif
 #ifdef SCARA
 	  SERIAL_PROTOCOLPGM("SCARA Theta:");
       SERIAL_PROTOCOL(delta[X_AXIS]);
@@ -5138,6 +6018,56 @@ Sigma_Exit:
       }
       break;
 	#endif
+#ifdef NONLINEAR_BED_LEVELING
+  #ifdef BED_LEVEL_EEPROM
+    case 374: // M374 Save the bed_level mesh to EEPROM
+      Config_StoreMesh();
+      break;
+    case 375: // M375 Load the bed_level mesh from EEPROM
+      if (Config_RetrieveMesh()) print_bed_level();
+      break;
+  #endif
+    case 376: // M376 Report the active bed_level mesh
+      print_bed_level();
+      break;
+#endif //NONLINEAR_BED_LEVELING
+#ifdef PROBE_TWO_SPEED
+    case 377: // M377 Set two-speed probing F<fast mm/s> S<slow mm/s> B<back-off mm>
+      if (code_seen('F')) probe_fast_feedrate = code_value();
+      if (code_seen('S')) probe_slow_feedrate = code_value();
+      if (code_seen('B')) probe_retap_backoff = code_value();
+      SERIAL_ECHO_START;
+      SERIAL_ECHOPAIR("Probe F", probe_fast_feedrate);
+      SERIAL_ECHOPAIR(" S", probe_slow_feedrate);
+      SERIAL_ECHOPAIR(" B", probe_retap_backoff);
+      SERIAL_ECHOLN("");
+      break;
+#endif
+#ifdef PROBE_LOG
+    case 378: // M378 Dump the probe log as CSV, C clears it
+      if (code_seen('C')) probe_log_clear();
+      else probe_log_dump();
+      break;
+#endif
+#ifdef PLANNER_TIMING
+    case 379: // M379 Report planner timing, C clears it
+      if (code_seen('C')) planner_timing_clear();
+      else planner_timing_report();
+      break;
+#endif
+#ifdef STEPPER_ISR_TIMING
+    case 380: // M380 Report stepper ISR timing, C clears it
+      if (code_seen('C')) st_timing_clear();
+      else st_timing_report();
+      break;
+#endif
+#ifdef BUFFER_STATS
+    case 381: // M381 Report planner underruns and buffer occupancy, C clears, S<seconds> auto-report interval
+      if (code_seen('S')) buffer_stats_interval = code_value();
+      else if (code_seen('C')) buffer_stats_clear();
+      else buffer_stats_report();
+      break;
+#endif
     case 400: // M400 finish all moves
     {
       st_synchronize();
@@ -5761,43 +6691,319 @@ void calculate_delta(float cartesian[3])
   */
 }
 
+// Effector position for the carriage heights delta_pos[], the inverse of
+// calculate_delta(). Working relative to the tower 1 carriage, subtracting its
+// rod sphere from the other two leaves x and y linear in z; the lower root of
+// the tower 1 sphere is then the effector.
+void calculate_cartesian(const float delta_pos[3], float cartesian[3])
+{
+  const float tower_x[3] = { delta_tower1_x, delta_tower2_x, delta_tower3_x };
+  const float tower_y[3] = { delta_tower1_y, delta_tower2_y, delta_tower3_y };
+  const float rod_2[3] = { DELTA_DIAGONAL_ROD1_2, DELTA_DIAGONAL_ROD2_2, DELTA_DIAGONAL_ROD3_2 };
+  calculate_cartesian(delta_pos, cartesian, tower_x, tower_y, rod_2);
+}
+
+// The same for a geometry other than the machine's: tower positions and squared rod lengths
+void calculate_cartesian(const float delta_pos[3], float cartesian[3],
+                         const float tower_x[3], const float tower_y[3], const float rod_2[3])
+{
+  float x2 = tower_x[1] - tower_x[0];
+  float y2 = tower_y[1] - tower_y[0];
+  float z2 = delta_pos[Y_AXIS] - delta_pos[X_AXIS];
+  float x3 = tower_x[2] - tower_x[0];
+  float y3 = tower_y[2] - tower_y[0];
+  float z3 = delta_pos[Z_AXIS] - delta_pos[X_AXIS];
+  float r2 = (sq(x2) + sq(y2) + sq(z2) + rod_2[0] - rod_2[1]) / 2;
+  float r3 = (sq(x3) + sq(y3) + sq(z3) + rod_2[0] - rod_2[2]) / 2;
+  float det = x2 * y3 - x3 * y2;
+  // x = ax + bx * z, y = ay + by * z
+  float ax = (r2 * y3 - r3 * y2) / det;
+  float bx = (z3 * y2 - z2 * y3) / det;
+  float ay = (x2 * r3 - x3 * r2) / det;
+  float by = (x3 * z2 - x2 * z3) / det;
+  // x^2 + y^2 + z^2 = rod^2
+  float a = sq(bx) + sq(by) + 1;
+  float b = ax * bx + ay * by;
+  float c = sq(ax) + sq(ay) - rod_2[0];
+  float z = (-b - sqrt(sq(b) - a * c)) / a;
+  cartesian[X_AXIS] = tower_x[0] + ax + bx * z;
+  cartesian[Y_AXIS] = tower_y[0] + ay + by * z;
+  cartesian[Z_AXIS] = delta_pos[X_AXIS] + z;
+}
+
+// Where the effector really is, from the stepper counts of the three towers.
+void get_cartesian_from_steppers(float cartesian[3])
+{
+  float delta_pos[3];
+  for (int8_t i = 0; i < 3; i++) {
+    delta_pos[i] = float(st_get_position(i)) / axis_steps_per_unit[i];
+  }
+  calculate_cartesian(delta_pos, cartesian);
+}
+
+#ifdef DELTA_INCREMENTAL_KINEMATICS
+// Incremental inverse kinematics for the segments of one straight move.
+// For tower i the term under the sqrt is a quadratic in the segment number,
+// q(s) = rod_2 - (tower_x - x(s))^2 - (tower_y - y(s))^2, so it is stepped by
+// forward differences. The root is predicted from the last two segments and
+// refined with one Newton step.
+static float delta_inc_step_x, delta_inc_step_y, delta_inc_curve;
+static float delta_inc_q[3], delta_inc_dq[3];
+static float delta_inc_root[3], delta_inc_root_prev[3];
+
+void calculate_delta_incremental_start(const float difference[3], int segments)
+{
+  delta_inc_step_x = difference[X_AXIS] / segments;
+  delta_inc_step_y = difference[Y_AXIS] / segments;
+  delta_inc_curve = -(sq(delta_inc_step_x) + sq(delta_inc_step_y));
+}
+
+// Segment number runs from 1 to segments, cartesian is the end of that segment.
+void calculate_delta_incremental(float cartesian[3], int segment, int segments)
+{
+  if (segment == 1 || segment == segments || segment % DELTA_INCREMENTAL_RESYNC == 0) {
+    // Exact solution, and restart the differences from here.
+    float tower_x[3] = { delta_tower1_x, delta_tower2_x, delta_tower3_x };
+    float tower_y[3] = { delta_tower1_y, delta_tower2_y, delta_tower3_y };
+    float rod_2[3] = { DELTA_DIAGONAL_ROD1_2, DELTA_DIAGONAL_ROD2_2, DELTA_DIAGONAL_ROD3_2 };
+    for (int8_t i = 0; i < 3; i++) {
+      float dx = tower_x[i] - cartesian[X_AXIS];
+      float dy = tower_y[i] - cartesian[Y_AXIS];
+      delta_inc_q[i] = rod_2[i] - sq(dx) - sq(dy);
+      delta_inc_dq[i] = 2 * (dx * delta_inc_step_x + dy * delta_inc_step_y) + delta_inc_curve;
+      delta_inc_root_prev[i] = delta_inc_root[i];
+      delta_inc_root[i] = sqrt(delta_inc_q[i]);
+      if (segment == 1) delta_inc_root_prev[i] = delta_inc_root[i];
+      delta[i] = delta_inc_root[i] + cartesian[Z_AXIS];
+    }
+    return;
+  }
+
+  for (int8_t i = 0; i < 3; i++) {
+    delta_inc_q[i] += delta_inc_dq[i];
+    delta_inc_dq[i] += 2 * delta_inc_curve;
+    float guess = 2 * delta_inc_root[i] - delta_inc_root_prev[i];
+    float correction = (delta_inc_q[i] - sq(guess)) / (2 * guess);
+    delta_inc_root_prev[i] = delta_inc_root[i];
+    // One Newton step leaves an error of about correction^2 / (2 * guess).
+    if (sq(correction) > 2 * DELTA_INCREMENTAL_TOLERANCE * guess)
+      delta_inc_root[i] = sqrt(delta_inc_q[i]);
+    else
+      delta_inc_root[i] = guess + correction;
+    delta[i] = delta_inc_root[i] + cartesian[Z_AXIS];
+  }
+}
+#endif //DELTA_INCREMENTAL_KINEMATICS
+
+#ifdef DELTA_ADAPTIVE_SEGMENTS
+// Number of segments that keeps every carriage within DELTA_SEGMENT_MAX_ERROR of
+// its true path. Along a straight move with t from 0 to 1 a tower height is
+// sqrt(q(t)) + z(t), q(t) = a + b*t + c*t^2, whose second derivative is
+// (4*a*c - b^2) / (4 * q^1.5). q is concave so the curvature peaks at one end
+// of the move, and n equal segments deviate from it by curvature / (8 * n^2).
+float delta_segments_for_error(const float start[3], const float difference[3])
+{
+  float tower_x[3] = { delta_tower1_x, delta_tower2_x, delta_tower3_x };
+  float tower_y[3] = { delta_tower1_y, delta_tower2_y, delta_tower3_y };
+  float rod_2[3] = { DELTA_DIAGONAL_ROD1_2, DELTA_DIAGONAL_ROD2_2, DELTA_DIAGONAL_ROD3_2 };
+  float c = -(sq(difference[X_AXIS]) + sq(difference[Y_AXIS]));
+  float curvature = 0;
+  for (int8_t i = 0; i < 3; i++) {
+    float dx = tower_x[i] - start[X_AXIS];
+    float dy = tower_y[i] - start[Y_AXIS];
+    float a = rod_2[i] - sq(dx) - sq(dy);
+    float b = 2 * (dx * difference[X_AXIS] + dy * difference[Y_AXIS]);
+    float q_min = min(a, a + b + c);
+    float k = fabs(4 * a * c - sq(b)) / (4 * q_min * sqrt(q_min));
+    if (k > curvature) curvature = k;
+  }
+  float segments = ceil(sqrt(curvature / (8 * DELTA_SEGMENT_MAX_ERROR)));
+  #ifdef NONLINEAR_BED_LEVELING
+    // Keep segments within about one bed_level cell so the mesh correction is still followed.
+    #if defined(BED_LEVEL_POLAR)
+      segments = max(segments, ceil(sqrt(-c) * BED_LEVEL_POLAR_RINGS / DELTA_PROBABLE_RADIUS));
+    #elif defined(BED_LEVEL_SUBDIVISION)
+      segments = max(segments, ceil(sqrt(-c) * bed_level_subdivision / AUTO_BED_LEVELING_GRID_X));
+    #else
+      segments = max(segments, ceil(sqrt(-c) / AUTO_BED_LEVELING_GRID_X));
+    #endif
+  #endif
+  return segments;
+}
+#endif //DELTA_ADAPTIVE_SEGMENTS
+
+#ifdef DELTA_FIXED_POINT_KINEMATICS
+// Fixed-point calculate_delta() that returns carriage positions in steps, so
+// plan_buffer_steps() can skip the float to steps conversion. Lengths are
+// steps with 8 fractional bits (Q24.8); squares are kept in whole steps^2,
+// which fits an unsigned long while a rod is shorter than 65000 steps. Longer
+// rods (or finer microstepping) fall back to the float path.
+static float delta_fixed_scale[3];
+static long delta_fixed_tower_x[3], delta_fixed_tower_y[3];
+static unsigned long delta_fixed_rod_2[3];
+static bool delta_fixed_ok = false;
+
+// Square of a Q24.8 length in whole steps^2, rounded.
+static unsigned long delta_fixed_sq(long length)
+{
+  unsigned long whole = labs(length);
+  unsigned long frac = whole & 0xFF;
+  whole >>= 8;
+  return whole * whole + ((2 * whole * frac + ((frac * frac) >> 8) + 128) >> 8);
+}
+
+// Square root of whole steps^2 in Q24.8 steps, digit by digit without division.
+// n must be exactly 32 bits wide: each pass shifts its top two bits out.
+static unsigned long delta_fixed_sqrt(uint32_t n)
+{
+  uint32_t rem = 0, root = 0;
+  for (uint8_t i = 0; i < 24; i++) {
+    rem = (rem << 2) | (n >> 30);
+    n <<= 2;
+    root <<= 1;
+    unsigned long test = (root << 1) | 1;
+    if (rem >= test) {
+      rem -= test;
+      root |= 1;
+    }
+  }
+  return root;
+}
+
+// Cache the tower geometry in steps. Called by set_delta_constants() (which
+// Config_RetrieveSettings() and Config_ResetDefault() call after loading the
+// steps per unit), M92 and the LCD steps/mm items.
+void calculate_delta_steps_init()
+{
+  float tower_x[3] = { delta_tower1_x, delta_tower2_x, delta_tower3_x };
+  float tower_y[3] = { delta_tower1_y, delta_tower2_y, delta_tower3_y };
+  float rod_2[3] = { DELTA_DIAGONAL_ROD1_2, DELTA_DIAGONAL_ROD2_2, DELTA_DIAGONAL_ROD3_2 };
+  delta_fixed_ok = true;
+  for (int8_t i = 0; i < 3; i++) {
+    float scale = axis_steps_per_unit[i] * 256;
+    delta_fixed_scale[i] = scale;
+    delta_fixed_tower_x[i] = lround(tower_x[i] * scale);
+    delta_fixed_tower_y[i] = lround(tower_y[i] * scale);
+    if (sqrt(rod_2[i]) * axis_steps_per_unit[i] < 65000)
+      delta_fixed_rod_2[i] = delta_fixed_sq(lround(sqrt(rod_2[i]) * scale));
+    else
+      delta_fixed_ok = false;
+  }
+}
+
+void calculate_delta_steps(float cartesian[3], long delta_steps[3])
+{
+  if (!delta_fixed_ok) {
+    calculate_delta(cartesian);
+    for (int8_t i = 0; i < 3; i++)
+      delta_steps[i] = lround(delta[i] * axis_steps_per_unit[i]);
+    return;
+  }
+  for (int8_t i = 0; i < 3; i++) {
+    float scale = delta_fixed_scale[i];
+    unsigned long radicand = delta_fixed_rod_2[i];
+    unsigned long d2 = delta_fixed_sq(delta_fixed_tower_x[i] - lround(cartesian[X_AXIS] * scale));
+    radicand = d2 < radicand ? radicand - d2 : 0;
+    d2 = delta_fixed_sq(delta_fixed_tower_y[i] - lround(cartesian[Y_AXIS] * scale));
+    radicand = d2 < radicand ? radicand - d2 : 0;
+    delta_steps[i] = (long(delta_fixed_sqrt(radicand)) + lround(cartesian[Z_AXIS] * scale) + 128) >> 8;
+  }
+}
+#endif //DELTA_FIXED_POINT_KINEMATICS
+
+#ifdef BED_LEVEL_POLAR
+// Print surface height at cartesian from the polar mesh. Within a sector the
+// height is bilinear in the radius and in the share of the two cross products
+// with the sector's spokes, which runs from 0 to 1 across the sector and so
+// needs no atan2(). atan2() is only used when the position enters another sector.
+float bed_level_offset(float cartesian[3])
+{
+  float x = cartesian[X_AXIS];
+  float y = cartesian[Y_AXIS];
+  float ring_pos = min(BED_LEVEL_POLAR_RINGS - 0.001, sqrt(sq(x) + sq(y)) * (BED_LEVEL_POLAR_RINGS / DELTA_PROBABLE_RADIUS));
+  int8_t ring = ring_pos;
+  float from_first = bed_level_spoke[0] * y - bed_level_spoke[1] * x;
+  float to_second = x * bed_level_spoke[3] - y * bed_level_spoke[2];
+  if (bed_level_cell_y < 0 || from_first < 0 || to_second < 0) {
+    int8_t spoke = int(atan2(y, x) * (BED_LEVEL_POLAR_SPOKES / (2 * PI)) + BED_LEVEL_POLAR_SPOKES) % BED_LEVEL_POLAR_SPOKES;
+    float angle = spoke * (2 * PI / BED_LEVEL_POLAR_SPOKES);
+    bed_level_spoke[0] = cos(angle);
+    bed_level_spoke[1] = sin(angle);
+    bed_level_spoke[2] = cos(angle + 2 * PI / BED_LEVEL_POLAR_SPOKES);
+    bed_level_spoke[3] = sin(angle + 2 * PI / BED_LEVEL_POLAR_SPOKES);
+    from_first = bed_level_spoke[0] * y - bed_level_spoke[1] * x;
+    to_second = x * bed_level_spoke[3] - y * bed_level_spoke[2];
+    bed_level_cell_y = spoke;
+    bed_level_cell_x = -1;
+  }
+  if (ring != bed_level_cell_x) {
+    int8_t first = bed_level_cell_y;
+    int8_t second = (first + 1) % BED_LEVEL_POLAR_SPOKES;
+    float z1 = ring ? bed_level_polar[ring-1][first] : bed_level_center;
+    float z2 = ring ? bed_level_polar[ring-1][second] : bed_level_center;
+    float z3 = bed_level_polar[ring][first];
+    float z4 = bed_level_polar[ring][second];
+    bed_level_cell[0] = z1;
+    bed_level_cell[1] = z3 - z1;
+    bed_level_cell[2] = z2 - z1;
+    bed_level_cell[3] = z4 - z3 - z2 + z1;
+    bed_level_cell_x = ring;
+  }
+  float ratio_r = ring_pos - ring;
+  float ratio_a = from_first + to_second > 0 ? from_first / (from_first + to_second) : 0;
+  return bed_level_cell[0] + ratio_r * bed_level_cell[1]
+         + ratio_a * (bed_level_cell[2] + ratio_r * bed_level_cell[3]);
+}
+#else
+// Print surface height at cartesian by linear interpolation over the bed_level array
+// (or over bed_level_mesh with BED_LEVEL_SUBDIVISION).
+// Consecutive segments mostly stay in one cell, so the cell's coefficients are kept
+// and only rebuilt when the position moves to another cell.
+float bed_level_offset(float cartesian[3])
+{
+  #ifdef BED_LEVEL_SUBDIVISION
+    #define BED_LEVEL_Z(x, y) BED_LEVEL_MESH(x, y)
+    int half = (bed_level_mesh_points - 1) / 2;
+    float scale_x = bed_level_subdivision * (1.0 / AUTO_BED_LEVELING_GRID_X);
+    float scale_y = bed_level_subdivision * (1.0 / AUTO_BED_LEVELING_GRID_Y);
+  #else
+    #define BED_LEVEL_Z(x, y) bed_level[x][y]
+    int half = (AUTO_BED_LEVELING_GRID_POINTS - 1) / 2;
+    const float scale_x = 1.0 / AUTO_BED_LEVELING_GRID_X;
+    const float scale_y = 1.0 / AUTO_BED_LEVELING_GRID_Y;
+  #endif
+  // Grid position counted from the first row and column, clamped inside the outer cells.
+  float grid_x = max(0.001, min(2*half-0.001, cartesian[X_AXIS] * scale_x + half));
+  float grid_y = max(0.001, min(2*half-0.001, cartesian[Y_AXIS] * scale_y + half));
+  int8_t cell_x = grid_x;
+  int8_t cell_y = grid_y;
+  if (cell_x != bed_level_cell_x || cell_y != bed_level_cell_y) {
+    float z1 = BED_LEVEL_Z(cell_x, cell_y);
+    float z2 = BED_LEVEL_Z(cell_x, cell_y+1);
+    float z3 = BED_LEVEL_Z(cell_x+1, cell_y);
+    float z4 = BED_LEVEL_Z(cell_x+1, cell_y+1);
+    bed_level_cell[0] = z1;
+    bed_level_cell[1] = z3 - z1;
+    bed_level_cell[2] = z2 - z1;
+    bed_level_cell[3] = z4 - z3 - z2 + z1;
+    bed_level_cell_x = cell_x;
+    bed_level_cell_y = cell_y;
+  }
+  float ratio_x = grid_x - cell_x;
+  float ratio_y = grid_y - cell_y;
+  return bed_level_cell[0] + ratio_x * bed_level_cell[1]
+         + ratio_y * (bed_level_cell[2] + ratio_x * bed_level_cell[3]);
+  #undef BED_LEVEL_Z
+}
+#endif //BED_LEVEL_POLAR
+
 // Adjust print surface height by linear interpolation over the bed_level array.
 void adjust_delta(float cartesian[3])
 {
-  int half = (AUTO_BED_LEVELING_GRID_POINTS - 1) / 2;
-  float grid_x = max(0.001-half, min(half-0.001, cartesian[X_AXIS] / AUTO_BED_LEVELING_GRID_X));
-  float grid_y = max(0.001-half, min(half-0.001, cartesian[Y_AXIS] / AUTO_BED_LEVELING_GRID_Y));
-  int floor_x = floor(grid_x);
-  int floor_y = floor(grid_y);
-  float ratio_x = grid_x - floor_x;
-  float ratio_y = grid_y - floor_y;
-  float z1 = bed_level[floor_x+half][floor_y+half];
-  float z2 = bed_level[floor_x+half][floor_y+half+1];
-  float z3 = bed_level[floor_x+half+1][floor_y+half];
-  float z4 = bed_level[floor_x+half+1][floor_y+half+1];
-  float left = (1-ratio_y)*z1 + ratio_y*z2;
-  float right = (1-ratio_y)*z3 + ratio_y*z4;
-  float offset = (1-ratio_x)*left + ratio_x*right;
-
+  float offset = bed_level_offset(cartesian);
   delta[X_AXIS] += offset;
   delta[Y_AXIS] += offset;
   delta[Z_AXIS] += offset;
-
-  /*
-  SERIAL_ECHOPGM("grid_x="); SERIAL_ECHO(grid_x);
-  SERIAL_ECHOPGM(" grid_y="); SERIAL_ECHO(grid_y);
-  SERIAL_ECHOPGM(" floor_x="); SERIAL_ECHO(floor_x);
-  SERIAL_ECHOPGM(" floor_y="); SERIAL_ECHO(floor_y);
-  SERIAL_ECHOPGM(" ratio_x="); SERIAL_ECHO(ratio_x);
-  SERIAL_ECHOPGM(" ratio_y="); SERIAL_ECHO(ratio_y);
-  SERIAL_ECHOPGM(" z1="); SERIAL_ECHO(z1);
-  SERIAL_ECHOPGM(" z2="); SERIAL_ECHO(z2);
-  SERIAL_ECHOPGM(" z3="); SERIAL_ECHO(z3);
-  SERIAL_ECHOPGM(" z4="); SERIAL_ECHO(z4);
-  SERIAL_ECHOPGM(" left="); SERIAL_ECHO(left);
-  SERIAL_ECHOPGM(" right="); SERIAL_ECHO(right);
-  SERIAL_ECHOPGM(" offset="); SERIAL_ECHOLN(offset);
-  */
 }
 
 void prepare_move_raw()
@@ -5867,22 +7073,51 @@ for (int s = 1; s <= steps; s++) {
   if (cartesian_mm < 0.000001) { cartesian_mm = abs(difference[E_AXIS]); }
   if (cartesian_mm < 0.000001) { return; }
   float seconds = 6000 * cartesian_mm / feedrate / feedmultiply;
-  int steps = max(1, int(delta_segments_per_second * seconds));
+  PLANNER_TIMING_START;
+  #ifdef DELTA_ADAPTIVE_SEGMENTS
+    // delta_segments_per_second is only the CPU budget here.
+    int steps = max(1, int(min(delta_segments_per_second * seconds, delta_segments_for_error(current_position, difference))));
+  #else
+    int steps = max(1, int(delta_segments_per_second * seconds));
+  #endif
   // SERIAL_ECHOPGM("mm="); SERIAL_ECHO(cartesian_mm);
   // SERIAL_ECHOPGM(" seconds="); SERIAL_ECHO(seconds);
   // SERIAL_ECHOPGM(" steps="); SERIAL_ECHOLN(steps);
+  #ifdef DELTA_INCREMENTAL_KINEMATICS
+    calculate_delta_incremental_start(difference, steps);
+  #endif
   for (int s = 1; s <= steps; s++) {
     float fraction = float(s) / float(steps);
     for(int8_t i=0; i < NUM_AXIS; i++) {
       destination[i] = current_position[i] + difference[i] * fraction;
     }
-    calculate_delta(destination);
-    #ifdef NONLINEAR_BED_LEVELING
-      adjust_delta(destination);
+    #ifdef DELTA_FIXED_POINT_KINEMATICS
+      long delta_steps[3];
+      #ifdef NONLINEAR_BED_LEVELING
+        float leveled[3] = { destination[X_AXIS], destination[Y_AXIS],
+                             destination[Z_AXIS] + bed_level_offset(destination) };
+        calculate_delta_steps(leveled, delta_steps);
+      #else
+        calculate_delta_steps(destination, delta_steps);
+      #endif
+      PLANNER_TIMING_END(PLANNER_TIMING_SEGMENT);
+      plan_buffer_steps(delta_steps, destination[E_AXIS],
+                        feedrate*feedmultiply/60/100.0, active_extruder);
+    #else
+      #ifdef DELTA_INCREMENTAL_KINEMATICS
+        calculate_delta_incremental(destination, s, steps);
+      #else
+        calculate_delta(destination);
+      #endif
+      #ifdef NONLINEAR_BED_LEVELING
+        adjust_delta(destination);
+      #endif
+      PLANNER_TIMING_END(PLANNER_TIMING_SEGMENT);
+      plan_buffer_line(delta[X_AXIS], delta[Y_AXIS], delta[Z_AXIS],
+                       destination[E_AXIS], feedrate*feedmultiply/60/100.0,
+                       active_extruder);
     #endif
-    plan_buffer_line(delta[X_AXIS], delta[Y_AXIS], delta[Z_AXIS],
-                     destination[E_AXIS], feedrate*feedmultiply/60/100.0,
-                     active_extruder);
+    PLANNER_TIMING_RESTART;
   }
 
 #endif // DELTA
@@ -6121,6 +7356,10 @@ void manage_inactivity()
   if(buflen < (BUFSIZE-1))
     get_command();
 
+  #ifdef BUFFER_STATS
+    buffer_stats_idle();
+  #endif
+
   if( (millis() - previous_millis_cmd) >  max_inactive_time )
     if(max_inactive_time)
       kill();
@@ -6323,4 +7562,4 @@ bool setTargetedHotend(int code){
   }
   return false;
 }
-
+
@@ -0,0 +1,88 @@
+/*
+  buffer_stats.cpp - planner starvation and buffer occupancy counters
+*/
+#include "Marlin.h"
+#include "buffer_stats.h"
+
+#ifdef BUFFER_STATS
+volatile bool buffer_stats_draining = false;
+volatile unsigned long buffer_underruns = 0;
+volatile uint8_t buffer_window_min_planned = 0xFF;
+unsigned int buffer_stats_interval = BUFFER_STATS_INTERVAL;
+
+static unsigned long window_underruns;       // buffer_underruns when the window started
+static unsigned long full_waits, full_wait_ms;
+static unsigned int full_wait_us;            // below one ms, not yet in full_wait_ms
+static unsigned long queue_depth[BUFSIZE];   // commands run with 1..BUFSIZE commands queued
+static unsigned long last_report;
+
+// Most waits are shorter than a millisecond, so they are timed in us;
+// the total is kept in ms so it does not wrap on a long print.
+void buffer_stats_full_wait(unsigned long us)
+{
+  full_waits++;
+  us += full_wait_us;
+  full_wait_ms += us / 1000;
+  full_wait_us = us % 1000;
+}
+
+void buffer_stats_command(uint8_t queued)
+{
+  if (queued > 0 && queued <= BUFSIZE) queue_depth[queued - 1]++;
+}
+
+void buffer_stats_idle()
+{
+  if (buffer_stats_interval == 0 || millis() - last_report < buffer_stats_interval * 1000UL) return;
+  SERIAL_ECHO_START;
+  buffer_stats_report();
+}
+
+void buffer_stats_report()
+{
+  CRITICAL_SECTION_START;
+  unsigned long underruns = buffer_underruns;
+  uint8_t min_planned = buffer_window_min_planned;
+  buffer_window_min_planned = 0xFF;
+  CRITICAL_SECTION_END;
+
+  SERIAL_PROTOCOLPGM("Buffer: ");
+  SERIAL_PROTOCOL(underruns);
+  SERIAL_PROTOCOLPGM(" underruns (");
+  SERIAL_PROTOCOL(underruns - window_underruns);
+  SERIAL_PROTOCOLPGM(" in window), fewest planned ");
+  if (min_planned == 0xFF) SERIAL_PROTOCOLPGM("-");
+  else SERIAL_PROTOCOL((int)min_planned);
+  SERIAL_PROTOCOLPGM(" of ");
+  SERIAL_PROTOCOL(BLOCK_BUFFER_SIZE - 1);
+  SERIAL_PROTOCOLPGM(" in window, ");
+  SERIAL_PROTOCOL(full_waits);
+  SERIAL_PROTOCOLPGM(" full-buffer waits ");
+  SERIAL_PROTOCOL(full_wait_ms);
+  SERIAL_PROTOCOLPGM(" ms, queue depth");
+  for (int8_t i = 0; i < BUFSIZE; i++) {
+    SERIAL_PROTOCOLPGM(" ");
+    SERIAL_PROTOCOL(i + 1);
+    SERIAL_PROTOCOLPGM(":");
+    SERIAL_PROTOCOL(queue_depth[i]);
+  }
+  SERIAL_PROTOCOLLNPGM("");
+
+  window_underruns = underruns;
+  last_report = millis();
+}
+
+void buffer_stats_clear()
+{
+  CRITICAL_SECTION_START;
+  buffer_underruns = 0;
+  buffer_window_min_planned = 0xFF;
+  CRITICAL_SECTION_END;
+  window_underruns = 0;
+  full_waits = 0;
+  full_wait_ms = 0;
+  full_wait_us = 0;
+  memset(queue_depth, 0, sizeof(queue_depth));
+  last_report = millis();
+}
+#endif // BUFFER_STATS
@@ -0,0 +1,41 @@
+/*
+  buffer_stats.h - planner starvation and buffer occupancy counters
+
+  The stepper ISR counts underruns, blocks that finished with nothing
+  queued behind them so the machine came to a stop, and the fewest
+  blocks left queued in the current window. plan_buffer_line() adds up
+  its waits for a free block, and loop() records how many commands were
+  queued each time it ran one. M381 reports and starts a new window; the
+  slicer's layer change G-code can send it for per-layer figures.
+*/
+#ifndef BUFFER_STATS_H
+#define BUFFER_STATS_H
+
+#include "Marlin.h"
+
+#ifdef BUFFER_STATS
+extern volatile bool buffer_stats_draining;   // st_synchronize() is emptying the planner on purpose
+extern volatile unsigned long buffer_underruns;
+extern volatile uint8_t buffer_window_min_planned;
+
+// Stepper ISR: a block finished, leaving planned blocks queued
+FORCE_INLINE void buffer_stats_block_done(uint8_t planned)
+{
+  if (buffer_stats_draining) return;
+  if (planned < buffer_window_min_planned) buffer_window_min_planned = planned;
+  if (planned == 0) buffer_underruns++;
+}
+
+// plan_buffer_line() waited us microseconds for a free block
+void buffer_stats_full_wait(unsigned long us);
+// loop() is about to run a command with queued commands in the buffer (including this one)
+void buffer_stats_command(uint8_t queued);
+// From manage_inactivity(): the automatic report every buffer_stats_interval seconds
+void buffer_stats_idle();
+
+void buffer_stats_report();
+void buffer_stats_clear();
+extern unsigned int buffer_stats_interval;
+#endif // BUFFER_STATS
+
+#endif // BUFFER_STATS_H
@@ -0,0 +1,85 @@
+/*
+  Arduino.h - Arduino core stand-ins for the host simulation build
+
+  Time only moves when the firmware looks at it: millis(), micros() and
+  the delay functions advance the simulator's virtual clock, which in
+  turn fires the timer and UART interrupts.  Pin functions go through
+  the same PORT/PIN/DDR variables the fastio macros use.
+*/
+#ifndef HOSTSIM_ARDUINO_H
+#define HOSTSIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "Print.h"
+#include "WString.h"
+
+#define F_CPU 16000000UL
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define PI 3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x)*(x))
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bit(b) (1UL << (b))
+
+inline double square(double x) { return x * x; }
+
+#define NUM_DIGITAL_PINS 70
+#define A0 54
+#define analogInputToDigitalPin(p) ((p) + A0)
+
+#define NOT_A_PIN 0
+#define NOT_A_PORT 0
+#define NOT_ON_TIMER 0
+
+unsigned long millis(void);
+unsigned long micros(void);
+
+// The virtual clock stands still while the planner computes, so
+// PLANNER_TIMING measures host CPU time instead.
+unsigned long hostsim_cpu_ns(void);
+#define PLANNER_TIMING_CLOCK() hostsim_cpu_ns()
+#define PLANNER_TIMING_TICKS_PER_US 1000
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+#endif
@@ -0,0 +1,19 @@
+/*
+  Print.h - minimal Print base class for the host simulation build
+
+  Only SdFile derives from it; the serial port has its own printer.
+*/
+#ifndef HOSTSIM_PRINT_H
+#define HOSTSIM_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class Print
+{
+  public:
+    virtual size_t write(uint8_t) = 0;
+    virtual ~Print() {}
+};
+
+#endif
@@ -0,0 +1,3 @@
+/*
+  SPI.h - empty stand-in for the host simulation build (no digipots)
+*/
@@ -0,0 +1,19 @@
+/*
+  WString.h - minimal String class for the host simulation build
+*/
+#ifndef HOSTSIM_WSTRING_H
+#define HOSTSIM_WSTRING_H
+
+#include <string.h>
+
+class String
+{
+  public:
+    String(const char *s = "") : str(s) {}
+    unsigned int length() const { return strlen(str); }
+    char operator[](unsigned int i) const { return str[i]; }
+  private:
+    const char *str;
+};
+
+#endif
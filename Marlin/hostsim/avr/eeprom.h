@@ -0,0 +1,12 @@
+/*
+  eeprom.h - EEPROM stand-ins for the host simulation build (RAM backed)
+*/
+#ifndef HOSTSIM_AVR_EEPROM_H
+#define HOSTSIM_AVR_EEPROM_H
+
+#include <stdint.h>
+
+uint8_t eeprom_read_byte(const uint8_t *addr);
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+
+#endif
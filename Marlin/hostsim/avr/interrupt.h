@@ -0,0 +1,18 @@
+/*
+  interrupt.h - interrupt stand-ins for the host simulation build
+
+  ISR bodies become plain functions that the simulator calls from its
+  virtual clock.  cli()/sei() only flip the I bit in SREG; the simulator
+  holds pending interrupts while it is clear.
+*/
+#ifndef HOSTSIM_AVR_INTERRUPT_H
+#define HOSTSIM_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector) extern "C" void vector(void)
+#define SIGNAL(vector) ISR(vector)
+#define cli() (SREG &= (uint8_t)~0x80)
+#define sei() (SREG |= 0x80)
+
+#endif
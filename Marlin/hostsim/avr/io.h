@@ -0,0 +1,175 @@
+/*
+  io.h - ATmega2560 register stand-ins for the host simulation build
+
+  Ports, timers and peripherals are plain host variables defined in
+  hostsim.cpp.  The few registers whose reads have side effects on real
+  silicon (TCNT1, UDR0, and the status bits the firmware busy-waits on)
+  are small classes so the simulator can model them.  Bit numbers match
+  the datasheet.
+*/
+#ifndef HOSTSIM_AVR_IO_H
+#define HOSTSIM_AVR_IO_H
+
+#include <stdint.h>
+
+#define __AVR_ATmega2560__ 1
+#define _BV(b) (1 << (b))
+#define _SFR_BYTE(sfr) (sfr)
+#define RAMEND 0x21FF
+#define E2END 0xFFF
+
+// A register whose reads always show some status bits set (UDRE0, SPIF):
+// the simulated peripheral is never busy.
+class hostsim_status_reg
+{
+  public:
+    hostsim_status_reg(uint8_t ready) : value(0), ready(ready) {}
+    operator uint8_t() const { return value | ready; }
+    hostsim_status_reg &operator=(uint8_t v) { value = v; return *this; }
+    hostsim_status_reg &operator|=(uint8_t v) { value |= v; return *this; }
+    hostsim_status_reg &operator&=(uint8_t v) { value &= v; return *this; }
+    volatile uint8_t value;
+  private:
+    const uint8_t ready;
+};
+
+// TCNT1 is derived from the virtual clock.
+class hostsim_timer1_count
+{
+  public:
+    operator uint16_t() const;
+    hostsim_timer1_count &operator=(uint16_t v);
+};
+
+// UDR0: writes go to the host, reads return the last received byte.
+class hostsim_uart_data
+{
+  public:
+    operator uint8_t() const;
+    hostsim_uart_data &operator=(uint8_t c);
+};
+
+#define HOSTSIM_PORT(P) \
+  extern volatile uint8_t PORT##P; \
+  extern volatile uint8_t PIN##P; \
+  extern volatile uint8_t DDR##P;
+HOSTSIM_PORT(A) HOSTSIM_PORT(B) HOSTSIM_PORT(C) HOSTSIM_PORT(D)
+HOSTSIM_PORT(E) HOSTSIM_PORT(F) HOSTSIM_PORT(G) HOSTSIM_PORT(H)
+HOSTSIM_PORT(J) HOSTSIM_PORT(K) HOSTSIM_PORT(L)
+#undef HOSTSIM_PORT
+
+#define HOSTSIM_PINS(P) \
+  P##0 = 0, P##1 = 1, P##2 = 2, P##3 = 3, P##4 = 4, P##5 = 5, P##6 = 6, P##7 = 7,
+enum {
+  HOSTSIM_PINS(PINA) HOSTSIM_PINS(PINB) HOSTSIM_PINS(PINC) HOSTSIM_PINS(PIND)
+  HOSTSIM_PINS(PINE) HOSTSIM_PINS(PINF) HOSTSIM_PINS(PING) HOSTSIM_PINS(PINH)
+  HOSTSIM_PINS(PINJ) HOSTSIM_PINS(PINK) HOSTSIM_PINS(PINL)
+};
+#undef HOSTSIM_PINS
+
+extern volatile uint8_t SREG;
+extern volatile uint8_t MCUSR;
+
+// Timer0 (millis in the Arduino core, temperature ISR on COMPB)
+extern volatile uint8_t TCCR0A, TCCR0B, TIMSK0, TIFR0, OCR0A, OCR0B, TCNT0;
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM00 0
+#define WGM01 1
+#define WGM02 3
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+
+// Timer1 (stepper ISR on COMPA)
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern hostsim_timer1_count TCNT1;
+extern volatile uint16_t OCR1A, OCR1B, OCR1C, ICR1;
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM10 0
+#define WGM11 1
+#define WGM12 3
+#define WGM13 4
+#define COM1A0 6
+#define COM1A1 7
+#define COM1B0 4
+#define COM1B1 5
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define TOV1 0
+#define OCF1A 1
+
+// Timer2 (fan soft PWM on some boards)
+extern volatile uint8_t TCCR2A, TCCR2B, TIMSK2, OCR2A, OCR2B, TCNT2;
+#define CS20 0
+#define CS21 1
+#define CS22 2
+
+// ADC
+extern volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR2;
+extern volatile uint16_t ADC;
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+#define MUX0 0
+#define MUX1 1
+#define MUX2 2
+#define MUX3 3
+#define MUX4 4
+#define ADLAR 5
+#define REFS0 6
+#define REFS1 7
+#define MUX5 3
+
+// USART0
+extern hostsim_status_reg UCSR0A;
+extern volatile uint8_t UCSR0B, UCSR0C, UBRR0H, UBRR0L;
+extern hostsim_uart_data UDR0;
+#define UCSR0A UCSR0A
+#define UBRR0H UBRR0H
+#define UDR0 UDR0
+#define MPCM0 0
+#define U2X0 1
+#define UPE0 2
+#define DOR0 3
+#define FE0 4
+#define UDRE0 5
+#define TXC0 6
+#define RXC0 7
+#define TXB80 0
+#define RXB80 1
+#define UCSZ02 2
+#define TXEN0 3
+#define RXEN0 4
+#define UDRIE0 5
+#define TXCIE0 6
+#define RXCIE0 7
+
+// SPI
+extern hostsim_status_reg SPSR;
+extern volatile uint8_t SPCR, SPDR;
+#define SPR0 0
+#define SPR1 1
+#define CPHA 2
+#define CPOL 3
+#define MSTR 4
+#define DORD 5
+#define SPE 6
+#define SPIE 7
+#define SPI2X 0
+#define WCOL 6
+#define SPIF 7
+
+// External interrupts
+extern volatile uint8_t EICRA, EICRB, EIMSK, EIFR;
+
+#endif
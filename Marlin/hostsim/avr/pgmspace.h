@@ -0,0 +1,32 @@
+/*
+  pgmspace.h - flash access stand-ins for the host simulation build
+*/
+#ifndef HOSTSIM_AVR_PGMSPACE_H
+#define HOSTSIM_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+typedef char prog_char;
+
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_byte_near(a) pgm_read_byte(a)
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_word_near(a) pgm_read_word(a)
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define pgm_read_float(a) (*(const float *)(a))
+#define pgm_read_float_near(a) pgm_read_float(a)
+
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strstr_P strstr
+#define strchr_P strchr
+#define sprintf_P sprintf
+
+#endif
@@ -0,0 +1,12 @@
+/*
+  wdt.h - watchdog stand-ins for the host simulation build
+*/
+#ifndef HOSTSIM_AVR_WDT_H
+#define HOSTSIM_AVR_WDT_H
+
+#define WDTO_4S 8
+#define wdt_enable(timeout) do {} while (0)
+#define wdt_disable() do {} while (0)
+#define wdt_reset() do {} while (0)
+
+#endif
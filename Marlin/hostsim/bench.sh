@@ -0,0 +1,37 @@
+#!/bin/sh
+# Planner benchmark: run a PLANNER_TIMING build of the simulator over
+# three generated workloads and any G-code files given, and print the
+# planner CPU figures of each run.
+#
+#   bench.sh ./Marlin.bench [file.gcode ...]
+#
+# SEGMENTS="120 160 200" repeats every workload at those delta segment
+# rates (M665 S) instead of the configured DELTA_SEGMENTS_PER_SECOND.
+#
+# The times are host CPU time: compare them with each other (buffer
+# sizes, segment rates, planner changes), not with the 16 MHz target.
+# M379 on a PLANNER_TIMING firmware gives the target's own figures.
+
+sim=${1:?usage: bench.sh ./Marlin.bench [file.gcode ...]}
+shift
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+. "$(dirname "$0")/workloads.sh"
+workloads "$dir"
+
+for segments in ${SEGMENTS:-default}; do
+  for file in "$dir"/*.gcode "$@"; do
+    name=$(basename "$file" .gcode)
+    if [ "$segments" = default ]; then
+      input=$file
+    else
+      name="$name @ $segments segments/s"
+      input="$dir/input.gcode"
+      { echo "M665 S$segments"; cat "$file"; } > "$input"
+    fi
+    echo "== $name"
+    "$sim" -q < "$input" 2>&1 >/dev/null |
+      awk '/^time / { print } /^planner CPU/ { p = 5 } p { print; p-- }'
+  done
+done
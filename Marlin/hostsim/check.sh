@@ -0,0 +1,40 @@
+#!/bin/sh
+# Regression check: run every check/*.gcode through the simulator and
+# compare its step stream with the golden trace next to it (.trc).
+#
+#   check.sh ./Marlin.sim       compare, exit 1 if any run differs
+#   check.sh -u ./Marlin.sim    write new golden traces
+#
+# Rewrite the goldens only after checking that the new step streams are
+# what the change meant to do (Marlin.sim -s prints a trace's summary).
+
+update=
+if [ "$1" = -u ]; then
+  update=1
+  shift
+fi
+sim=${1:?usage: check.sh [-u] ./Marlin.sim}
+dir=$(dirname "$0")/check
+log=$(mktemp)
+trap 'rm -f "$log"' EXIT
+
+failed=0
+for file in "$dir"/*.gcode; do
+  name=$(basename "$file" .gcode)
+  golden="$dir/$name.trc"
+  if [ -n "$update" ]; then
+    "$sim" -q -o "$golden" < "$file" > /dev/null 2> "$log"
+    status=$?
+  else
+    "$sim" -q -g "$golden" < "$file" > /dev/null 2> "$log"
+    status=$?
+  fi
+  if [ $status -eq 0 ]; then
+    echo "PASS $name"
+  else
+    echo "FAIL $name"
+    grep -E '^(trace|hostsim):' "$log"
+    failed=1
+  fi
+done
+exit $failed
@@ -0,0 +1,16 @@
+; Zigzags under different acceleration and jerk settings
+G92 X0 Y0 Z0
+G1 X-15 Y-15 Z2 F6000
+M204 S500
+M205 X5
+G1 X15 Y-10 F9000
+G1 X-15 Y-5
+M204 S3000
+M205 X20
+G1 X15 Y0 F9000
+G1 X-15 Y5
+M201 X1000 Y1000 Z1000
+G1 X15 Y10 Z4 F9000
+M205 X0
+G1 X-15 Y15 Z2
+G1 X0 Y0 Z3 F9000
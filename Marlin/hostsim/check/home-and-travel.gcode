@@ -0,0 +1,13 @@
+; Homing, then travel moves at several feedrates and heights
+G28
+G1 Z250 F3000
+G0 X20 Y0 F9000
+G0 X-10 Y17 F9000
+G0 X-10 Y-17 F12000
+G0 X20 Y0 F12000
+G1 X0 Y0 Z245 F1500
+G4 P200
+G1 X0 Y25 Z255 F6000
+G1 X-22 Y-12 F6000
+G1 X22 Y-12 F6000
+G1 X0 Y25 F6000
@@ -0,0 +1,161 @@
+; Slicer-style perimeters: short extruding segments around two circles,
+; with a retract, hop and travel between them
+G92 X0 Y0 Z0 E0
+M302
+G1 X10 Y0 Z0.3 F6000
+G1 X9.945 Y1.045 E0.0200 F2400
+G1 X9.781 Y2.079 E0.0400 F2400
+G1 X9.511 Y3.090 E0.0600 F2400
+G1 X9.135 Y4.067 E0.0800 F2400
+G1 X8.660 Y5.000 E0.1000 F2400
+G1 X8.090 Y5.878 E0.1200 F2400
+G1 X7.431 Y6.691 E0.1400 F2400
+G1 X6.691 Y7.431 E0.1600 F2400
+G1 X5.878 Y8.090 E0.1800 F2400
+G1 X5.000 Y8.660 E0.2000 F2400
+G1 X4.067 Y9.135 E0.2200 F2400
+G1 X3.090 Y9.511 E0.2400 F2400
+G1 X2.079 Y9.781 E0.2600 F2400
+G1 X1.045 Y9.945 E0.2800 F2400
+G1 X0.000 Y10.000 E0.3000 F2400
+G1 X-1.045 Y9.945 E0.3200 F2400
+G1 X-2.079 Y9.781 E0.3400 F2400
+G1 X-3.090 Y9.511 E0.3600 F2400
+G1 X-4.067 Y9.135 E0.3800 F2400
+G1 X-5.000 Y8.660 E0.4000 F2400
+G1 X-5.878 Y8.090 E0.4200 F2400
+G1 X-6.691 Y7.431 E0.4400 F2400
+G1 X-7.431 Y6.691 E0.4600 F2400
+G1 X-8.090 Y5.878 E0.4800 F2400
+G1 X-8.660 Y5.000 E0.5000 F2400
+G1 X-9.135 Y4.067 E0.5200 F2400
+G1 X-9.511 Y3.090 E0.5400 F2400
+G1 X-9.781 Y2.079 E0.5600 F2400
+G1 X-9.945 Y1.045 E0.5800 F2400
+G1 X-10.000 Y0.000 E0.6000 F2400
+G1 X-9.945 Y-1.045 E0.6200 F2400
+G1 X-9.781 Y-2.079 E0.6400 F2400
+G1 X-9.511 Y-3.090 E0.6600 F2400
+G1 X-9.135 Y-4.067 E0.6800 F2400
+G1 X-8.660 Y-5.000 E0.7000 F2400
+G1 X-8.090 Y-5.878 E0.7200 F2400
+G1 X-7.431 Y-6.691 E0.7400 F2400
+G1 X-6.691 Y-7.431 E0.7600 F2400
+G1 X-5.878 Y-8.090 E0.7800 F2400
+G1 X-5.000 Y-8.660 E0.8000 F2400
+G1 X-4.067 Y-9.135 E0.8200 F2400
+G1 X-3.090 Y-9.511 E0.8400 F2400
+G1 X-2.079 Y-9.781 E0.8600 F2400
+G1 X-1.045 Y-9.945 E0.8800 F2400
+G1 X-0.000 Y-10.000 E0.9000 F2400
+G1 X1.045 Y-9.945 E0.9200 F2400
+G1 X2.079 Y-9.781 E0.9400 F2400
+G1 X3.090 Y-9.511 E0.9600 F2400
+G1 X4.067 Y-9.135 E0.9800 F2400
+G1 X5.000 Y-8.660 E1.0000 F2400
+G1 X5.878 Y-8.090 E1.0200 F2400
+G1 X6.691 Y-7.431 E1.0400 F2400
+G1 X7.431 Y-6.691 E1.0600 F2400
+G1 X8.090 Y-5.878 E1.0800 F2400
+G1 X8.660 Y-5.000 E1.1000 F2400
+G1 X9.135 Y-4.067 E1.1200 F2400
+G1 X9.511 Y-3.090 E1.1400 F2400
+G1 X9.781 Y-2.079 E1.1600 F2400
+G1 X9.945 Y-1.045 E1.1800 F2400
+G1 X10.000 Y-0.000 E1.2000 F2400
+G1 E-0.8000 F2700
+G1 Z1.3 F3000
+G0 X15 Y0 F9000
+G1 Z0.3 F3000
+G1 E1.2000 F2700
+G1 X14.963 Y1.046 E1.2250 F1800
+G1 X14.854 Y2.088 E1.2500 F1800
+G1 X14.672 Y3.119 E1.2750 F1800
+G1 X14.419 Y4.135 E1.3000 F1800
+G1 X14.095 Y5.130 E1.3250 F1800
+G1 X13.703 Y6.101 E1.3500 F1800
+G1 X13.244 Y7.042 E1.3750 F1800
+G1 X12.721 Y7.949 E1.4000 F1800
+G1 X12.135 Y8.817 E1.4250 F1800
+G1 X11.491 Y9.642 E1.4500 F1800
+G1 X10.790 Y10.420 E1.4750 F1800
+G1 X10.037 Y11.147 E1.5000 F1800
+G1 X9.235 Y11.820 E1.5250 F1800
+G1 X8.388 Y12.436 E1.5500 F1800
+G1 X7.500 Y12.990 E1.5750 F1800
+G1 X6.576 Y13.482 E1.6000 F1800
+G1 X5.619 Y13.908 E1.6250 F1800
+G1 X4.635 Y14.266 E1.6500 F1800
+G1 X3.629 Y14.554 E1.6750 F1800
+G1 X2.605 Y14.772 E1.7000 F1800
+G1 X1.568 Y14.918 E1.7250 F1800
+G1 X0.523 Y14.991 E1.7500 F1800
+G1 X-0.523 Y14.991 E1.7750 F1800
+G1 X-1.568 Y14.918 E1.8000 F1800
+G1 X-2.605 Y14.772 E1.8250 F1800
+G1 X-3.629 Y14.554 E1.8500 F1800
+G1 X-4.635 Y14.266 E1.8750 F1800
+G1 X-5.619 Y13.908 E1.9000 F1800
+G1 X-6.576 Y13.482 E1.9250 F1800
+G1 X-7.500 Y12.990 E1.9500 F1800
+G1 X-8.388 Y12.436 E1.9750 F1800
+G1 X-9.235 Y11.820 E2.0000 F1800
+G1 X-10.037 Y11.147 E2.0250 F1800
+G1 X-10.790 Y10.420 E2.0500 F1800
+G1 X-11.491 Y9.642 E2.0750 F1800
+G1 X-12.135 Y8.817 E2.1000 F1800
+G1 X-12.721 Y7.949 E2.1250 F1800
+G1 X-13.244 Y7.042 E2.1500 F1800
+G1 X-13.703 Y6.101 E2.1750 F1800
+G1 X-14.095 Y5.130 E2.2000 F1800
+G1 X-14.419 Y4.135 E2.2250 F1800
+G1 X-14.672 Y3.119 E2.2500 F1800
+G1 X-14.854 Y2.088 E2.2750 F1800
+G1 X-14.963 Y1.046 E2.3000 F1800
+G1 X-15.000 Y0.000 E2.3250 F1800
+G1 X-14.963 Y-1.046 E2.3500 F1800
+G1 X-14.854 Y-2.088 E2.3750 F1800
+G1 X-14.672 Y-3.119 E2.4000 F1800
+G1 X-14.419 Y-4.135 E2.4250 F1800
+G1 X-14.095 Y-5.130 E2.4500 F1800
+G1 X-13.703 Y-6.101 E2.4750 F1800
+G1 X-13.244 Y-7.042 E2.5000 F1800
+G1 X-12.721 Y-7.949 E2.5250 F1800
+G1 X-12.135 Y-8.817 E2.5500 F1800
+G1 X-11.491 Y-9.642 E2.5750 F1800
+G1 X-10.790 Y-10.420 E2.6000 F1800
+G1 X-10.037 Y-11.147 E2.6250 F1800
+G1 X-9.235 Y-11.820 E2.6500 F1800
+G1 X-8.388 Y-12.436 E2.6750 F1800
+G1 X-7.500 Y-12.990 E2.7000 F1800
+G1 X-6.576 Y-13.482 E2.7250 F1800
+G1 X-5.619 Y-13.908 E2.7500 F1800
+G1 X-4.635 Y-14.266 E2.7750 F1800
+G1 X-3.629 Y-14.554 E2.8000 F1800
+G1 X-2.605 Y-14.772 E2.8250 F1800
+G1 X-1.568 Y-14.918 E2.8500 F1800
+G1 X-0.523 Y-14.991 E2.8750 F1800
+G1 X0.523 Y-14.991 E2.9000 F1800
+G1 X1.568 Y-14.918 E2.9250 F1800
+G1 X2.605 Y-14.772 E2.9500 F1800
+G1 X3.629 Y-14.554 E2.9750 F1800
+G1 X4.635 Y-14.266 E3.0000 F1800
+G1 X5.619 Y-13.908 E3.0250 F1800
+G1 X6.576 Y-13.482 E3.0500 F1800
+G1 X7.500 Y-12.990 E3.0750 F1800
+G1 X8.388 Y-12.436 E3.1000 F1800
+G1 X9.235 Y-11.820 E3.1250 F1800
+G1 X10.037 Y-11.147 E3.1500 F1800
+G1 X10.790 Y-10.420 E3.1750 F1800
+G1 X11.491 Y-9.642 E3.2000 F1800
+G1 X12.135 Y-8.817 E3.2250 F1800
+G1 X12.721 Y-7.949 E3.2500 F1800
+G1 X13.244 Y-7.042 E3.2750 F1800
+G1 X13.703 Y-6.101 E3.3000 F1800
+G1 X14.095 Y-5.130 E3.3250 F1800
+G1 X14.419 Y-4.135 E3.3500 F1800
+G1 X14.672 Y-3.119 E3.3750 F1800
+G1 X14.854 Y-2.088 E3.4000 F1800
+G1 X14.963 Y-1.046 E3.4250 F1800
+G1 X15.000 Y-0.000 E3.4500 F1800
+G1 Z3 F3000
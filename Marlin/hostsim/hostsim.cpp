@@ -0,0 +1,916 @@
+/*
+  hostsim.cpp - run the firmware core on a Linux host
+
+  Stands in for the Arduino core and the ATmega2560 peripherals the
+  firmware touches: a 16 MHz virtual clock drives Timer1 (stepper ISR),
+  Timer0 COMPB (temperature ISR) and the USART0 receive interrupt.  The
+  clock only advances when the firmware waits on it (millis(), micros(),
+  delays, serial output), plus a modelled cost for every interrupt, so a
+  run is deterministic and independent of host speed.  TCNT1 reads inside
+  the stepper ISR see its cost accrue, so the ISR can time itself.
+
+  G-code is read from stdin and fed to the firmware at the configured
+  baud rate, one line per "ok" like a host program would.  Firmware
+  output goes to stdout; the run statistics go to stderr at exit.
+
+  The machine behind the pins is an ideal delta: three carriages that
+  trip their MAX endstops at the homing height and an effector whose
+  MIN endstops (the FSR bed probe) read triggered at or below the bed,
+  flat at Z = 0 unless a test shapes it.
+  The hotend and bed are first-order thermal models feeding the ADC
+  through a 100k beta thermistor on a 4.7k pull-up.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Marlin.h"
+#include "planner.h"
+#include "stepper.h"
+#include "temperature.h"
+#include "trace.h"
+#include "hostsim.h"
+
+extern "C" void TIMER1_COMPA_vect(void);
+extern "C" void TIMER0_COMPB_vect(void);
+extern "C" void USART0_RX_vect(void);
+
+extern volatile long count_position[NUM_AXIS];
+
+void setup();
+void loop();
+
+// Modelled interrupt and polling costs in CPU cycles.  These are rough
+// figures for a 16 MHz ATmega2560; adjust them to taste.
+#define HOSTSIM_POLL_CYCLES         400  // each millis()/micros() call, i.e. one pass of a wait loop
+#define HOSTSIM_STEPPER_ISR_CYCLES  350  // stepper ISR entry, bookkeeping and exit
+#define HOSTSIM_STEP_CYCLES         100  // each motor step the ISR issues
+#define HOSTSIM_TEMP_ISR_CYCLES     600  // temperature ISR
+
+#define HOSTSIM_TIMER0_PERIOD 16384  // prescaler 64, 256 counts
+
+#define HOSTSIM_AMBIENT 25.0
+#define HOSTSIM_DROP 50.0  // carriages start this far below their endstops
+
+//===========================================================================
+//=============================registers      ================================
+//===========================================================================
+
+#define HOSTSIM_PORT(P) \
+  volatile uint8_t PORT##P; \
+  volatile uint8_t PIN##P; \
+  volatile uint8_t DDR##P;
+HOSTSIM_PORT(A) HOSTSIM_PORT(B) HOSTSIM_PORT(C) HOSTSIM_PORT(D)
+HOSTSIM_PORT(E) HOSTSIM_PORT(F) HOSTSIM_PORT(G) HOSTSIM_PORT(H)
+HOSTSIM_PORT(J) HOSTSIM_PORT(K) HOSTSIM_PORT(L)
+#undef HOSTSIM_PORT
+
+volatile uint8_t SREG, MCUSR;
+volatile uint8_t TCCR0A, TCCR0B, TIMSK0, TIFR0, OCR0A, OCR0B, TCNT0;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint16_t OCR1A, OCR1B, OCR1C, ICR1;
+hostsim_timer1_count TCNT1;
+volatile uint8_t TCCR2A, TCCR2B, TIMSK2, OCR2A, OCR2B, TCNT2;
+volatile uint8_t ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR2;
+volatile uint16_t ADC;
+hostsim_status_reg UCSR0A(1 << UDRE0);
+volatile uint8_t UCSR0B, UCSR0C, UBRR0H, UBRR0L;
+hostsim_uart_data UDR0;
+hostsim_status_reg SPSR(1 << SPIF);
+volatile uint8_t SPCR, SPDR;
+volatile uint8_t EICRA, EICRB, EIMSK, EIFR;
+
+// Arduino Mega pin numbers to ports, built from the fastio tables.
+struct hostsim_pin {
+  volatile uint8_t *out;
+  volatile uint8_t *in;
+  volatile uint8_t *ddr;
+  uint8_t bit;
+};
+#define P(n) { &DIO##n##_WPORT, &DIO##n##_RPORT, &DIO##n##_DDR, DIO##n##_PIN }
+static const hostsim_pin pin_map[NUM_DIGITAL_PINS] = {
+  P(0),  P(1),  P(2),  P(3),  P(4),  P(5),  P(6),  P(7),  P(8),  P(9),
+  P(10), P(11), P(12), P(13), P(14), P(15), P(16), P(17), P(18), P(19),
+  P(20), P(21), P(22), P(23), P(24), P(25), P(26), P(27), P(28), P(29),
+  P(30), P(31), P(32), P(33), P(34), P(35), P(36), P(37), P(38), P(39),
+  P(40), P(41), P(42), P(43), P(44), P(45), P(46), P(47), P(48), P(49),
+  P(50), P(51), P(52), P(53), P(54), P(55), P(56), P(57), P(58), P(59),
+  P(60), P(61), P(62), P(63), P(64), P(65), P(66), P(67), P(68), P(69)
+};
+#undef P
+
+// External interrupt number to pin (Arduino Mega numbering)
+static const int8_t interrupt_pin[6] = { 2, 3, 21, 20, 19, 18 };
+static void (*interrupt_handler[6])(void);
+static int interrupt_mode[6];
+
+//===========================================================================
+//=============================simulator state  ==============================
+//===========================================================================
+
+static uint64_t now;              // virtual clock, CPU cycles
+static bool in_isr;
+static uint64_t t1_zero;          // when TCNT1 last read 0
+static uint64_t t1_seen;          // Timer1 matches are accounted for up to here
+static bool in_stepper_isr;
+static long stepper_isr_before[NUM_AXIS];  // count_position at stepper ISR entry
+static int stepper_isr_reads;     // TCNT1 reads in this stepper ISR
+static uint64_t t0_next = HOSTSIM_TIMER0_PERIOD;
+static bool t1_flag, t0_flag;     // compare match flags (OCF1A, OCF0B)
+static uint64_t limit;            // stop after this many cycles, 0 = never
+
+static double host_scale;         // charge main-line code at this multiple of host CPU time
+static uint64_t host_mark;        // host CPU time at the last clock update, ns
+static bool quiet;
+
+// Step trace (see trace.h)
+#define HOSTSIM_TRACE_RATE (F_CPU / 8)
+static const char *trace_out, *trace_golden;
+static float trace_tolerance = 1;
+static long trace_slack;
+static uint64_t trace_last;       // Timer1 tick of the last trace event
+
+// Serial link
+static uint8_t rx_latch;
+static uint64_t rx_next;          // when the next byte is on the wire
+static uint64_t tx_free;          // when the transmitter is free again
+static char line[MAX_CMD_SIZE + 2];
+static int line_len, line_pos;
+static bool awaiting_ok, input_done;
+static FILE *gcode_in;            // G-code source, stdin when NULL
+static char reply[8];
+static int reply_len;
+#ifdef HOSTSIM_TEST
+static char output[16384];        // firmware output for hostsim_output()
+static int output_len;
+#endif
+
+// Machine
+static float tower_top;
+static long carriage_steps[3];
+static float carriage[3];
+static float effector[3];
+static bool bed_contact;
+static float (*bed_shape)(float x, float y);  // bed height, flat at 0 when NULL
+static float dragged;             // effector travel in X/Y with the probe pressed, mm
+static double temp_hotend = HOSTSIM_AMBIENT, temp_bed = HOSTSIM_AMBIENT;
+
+// Statistics
+static unsigned long stepper_isrs, stepper_idle_isrs, temp_isrs;
+static uint64_t stepper_cycles, temp_cycles, stepper_worst;
+static unsigned long steps[NUM_AXIS];
+static unsigned long lines_sent, bytes_rx, bytes_tx, oks;
+static unsigned long underruns;
+static uint64_t busy_cycles, starved_cycles, stalled_cycles;
+static bool was_busy;
+static float deepest = 1e9;
+static long chord_start[3];       // carriage steps where the running block began
+static float chord_worst;         // worst carriage deviation from the straight path, mm
+static unsigned long chord_blocks;
+static volatile unsigned long polls;
+
+static void pass(uint64_t t);
+static void report();
+static uint64_t stepper_isr_elapsed();
+
+// The firmware has acknowledged everything and is waiting on the serial
+// line for more; an empty planner now means the link is the bottleneck.
+static bool waiting_for_host()
+{
+  return !awaiting_ok && !input_done;
+}
+
+//===========================================================================
+//=============================clock            ==============================
+//===========================================================================
+
+static unsigned long byte_cycles()
+{
+  unsigned long ubrr = ((unsigned long)UBRR0H << 8) | UBRR0L;
+  return 10 * (ubrr + 1) * ((UCSR0A & (1 << U2X0)) ? 8 : 16);
+}
+
+static unsigned long timer1_prescale()
+{
+  static const unsigned short div[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+  return div[TCCR1B & 7];
+}
+
+static uint64_t timer1_due()
+{
+  unsigned long div = timer1_prescale();
+  if (!div)
+    return UINT64_MAX;
+  uint64_t ticks = (t1_seen - t1_zero) / div;
+  uint64_t match = OCR1A;
+  while (match < ticks)
+    match += 0x10000;  // compare missed, wait for the wrap
+  return t1_zero + (match + 1) * div;
+}
+
+static bool rx_ready();
+
+static bool interrupts_on()
+{
+  return (SREG & 0x80) && !in_isr;
+}
+
+static float thermistor_adc(double t)
+{
+  double r = 100000.0 * exp(4267.0 * (1.0 / (t + 273.15) - 1.0 / 298.15));
+  return 1023.0 * r / (r + 4700.0);
+}
+
+static bool output_high(int pin)
+{
+  return pin >= 0 && (*pin_map[pin].out & (1 << pin_map[pin].bit));
+}
+
+static void set_input(int pin, bool level)
+{
+  if (pin < 0)
+    return;
+  const hostsim_pin &p = pin_map[pin];
+  bool old = *p.in & (1 << p.bit);
+  if (level)
+    *p.in |= 1 << p.bit;
+  else
+    *p.in &= ~(1 << p.bit);
+  if (old == level)
+    return;
+  for (uint8_t i = 0; i < 6; i++) {
+    if (interrupt_pin[i] != pin || !interrupt_handler[i])
+      continue;
+    if (interrupt_mode[i] == CHANGE || interrupt_mode[i] == (level ? RISING : FALLING)) {
+      bool nested = in_isr;
+      in_isr = true;
+      interrupt_handler[i]();
+      in_isr = nested;
+    }
+  }
+}
+
+static void update_endstops();
+
+static float bed_height(float x, float y)
+{
+  return bed_shape ? bed_shape(x, y) : 0;
+}
+
+// Move the physical machine by the steps the last stepper ISR issued and
+// update the endstop inputs.
+static void update_machine(const long before[NUM_AXIS])
+{
+  bool moved = false;
+  for (int8_t i = 0; i < NUM_AXIS; i++) {
+    long d = count_position[i] - before[i];
+    if (!d)
+      continue;
+    steps[i] += labs(d);
+    if (i < 3) {
+      carriage_steps[i] += d;
+      moved = true;
+    }
+  }
+  if (!moved)
+    return;
+
+  for (int8_t i = 0; i < 3; i++)
+    carriage[i] = tower_top - HOSTSIM_DROP + carriage_steps[i] / axis_steps_per_unit[i];
+  float was_x = effector[X_AXIS], was_y = effector[Y_AXIS];
+  bool was_pressed = bed_contact;
+  calculate_cartesian(carriage, effector);
+  bed_contact = effector[Z_AXIS] <= bed_height(effector[X_AXIS], effector[Y_AXIS]);
+  if (was_pressed && bed_contact)
+    dragged += sqrt(sq(effector[X_AXIS] - was_x) + sq(effector[Y_AXIS] - was_y));
+  if (effector[Z_AXIS] < deepest)
+    deepest = effector[Z_AXIS];
+  update_endstops();
+}
+
+static void update_endstops()
+{
+  set_input(X_MAX_PIN, (carriage[X_AXIS] >= tower_top) != X_MAX_ENDSTOP_INVERTING);
+  set_input(Y_MAX_PIN, (carriage[Y_AXIS] >= tower_top) != Y_MAX_ENDSTOP_INVERTING);
+  set_input(Z_MAX_PIN, (carriage[Z_AXIS] >= tower_top) != Z_MAX_ENDSTOP_INVERTING);
+  set_input(X_MIN_PIN, bed_contact != X_MIN_ENDSTOP_INVERTING);
+  set_input(Y_MIN_PIN, bed_contact != Y_MIN_ENDSTOP_INVERTING);
+  set_input(Z_MIN_PIN, bed_contact != Z_MIN_ENDSTOP_INVERTING);
+}
+
+// Cycles the stepper ISR has used so far, as seen by its own TCNT1
+// reads: nothing at the first read (ISR entry), then the modelled cost
+// of the entry and the steps issued up to that read.
+static uint64_t stepper_isr_elapsed()
+{
+  if (!in_stepper_isr || !stepper_isr_reads++)
+    return 0;
+  unsigned long issued = 0;
+  for (int8_t i = 0; i < NUM_AXIS; i++)
+    issued += labs(count_position[i] - stepper_isr_before[i]);
+  return HOSTSIM_STEPPER_ISR_CYCLES + issued * HOSTSIM_STEP_CYCLES;
+}
+
+// A block moves the carriages in a straight line (the chord) while the
+// move it stands for is straight in Cartesian space.  When a block ends,
+// measure how far the chord strayed from the carriage heights of the
+// straight path between the block's end points, a quarter, half and
+// three quarters of the way along.  Blocks an endstop cut short are left
+// out, since their carriages did not all run to the end, and so are blocks
+// that leave a carriage where it was: those are the tower moves of G28,
+// planned in carriage space.
+static void check_chord(const block_t *block)
+{
+  const long planned[3] = { block->steps_x, block->steps_y, block->steps_z };
+  float start[3], from[3], to[3], point[3];
+  bool counts = true;
+  for (int8_t i = 0; i < 3; i++) {
+    long d = labs(carriage_steps[i] - chord_start[i]);
+    counts &= d != 0 && d == planned[i];
+    start[i] = tower_top - HOSTSIM_DROP + chord_start[i] / axis_steps_per_unit[i];
+    chord_start[i] = carriage_steps[i];
+  }
+  if (!counts)
+    return;
+
+  chord_blocks++;
+  float saved[3] = { delta[X_AXIS], delta[Y_AXIS], delta[Z_AXIS] };  // the firmware's, in use
+  calculate_cartesian(start, from);
+  calculate_cartesian(carriage, to);
+  for (int8_t k = 1; k < 4; k++) {
+    float t = k / 4.0;
+    for (int8_t i = 0; i < 3; i++)
+      point[i] = from[i] + t * (to[i] - from[i]);
+    calculate_delta(point);
+    for (int8_t i = 0; i < 3; i++) {
+      float deviation = fabs(start[i] + t * (carriage[i] - start[i]) - delta[i]);
+      if (deviation > chord_worst)
+        chord_worst = deviation;
+    }
+  }
+  for (int8_t i = 0; i < 3; i++)
+    delta[i] = saved[i];
+}
+
+static void stepper_interrupt()
+{
+  long *before = stepper_isr_before;
+  for (int8_t i = 0; i < NUM_AXIS; i++)
+    before[i] = count_position[i];
+
+  unsigned char tail = block_buffer_tail;
+  uint64_t entry = now / (F_CPU / HOSTSIM_TRACE_RATE);
+  bool busy = blocks_queued();
+  if (!busy) {
+    stepper_idle_isrs++;
+    if (was_busy && !input_done)
+      underruns++;
+  }
+  was_busy = busy;
+
+  in_isr = in_stepper_isr = true;
+  stepper_isr_reads = 0;
+  TIMER1_COMPA_vect();
+  in_isr = in_stepper_isr = false;
+
+  unsigned long issued = 0;
+  long d[NUM_AXIS];
+  for (int8_t i = 0; i < NUM_AXIS; i++) {
+    d[i] = count_position[i] - before[i];
+    issued += labs(d[i]);
+  }
+  if (issued) {
+    trace_step(entry - trace_last, d);
+    trace_last = entry;
+  }
+  if (block_buffer_tail != tail) {
+    trace_block_end(entry - trace_last);
+    trace_last = entry;
+  }
+  uint64_t cost = HOSTSIM_STEPPER_ISR_CYCLES + issued * HOSTSIM_STEP_CYCLES;
+  stepper_isrs++;
+  stepper_cycles += cost;
+  if (cost > stepper_worst)
+    stepper_worst = cost;
+  pass(now + cost);
+  t1_seen = now;  // OCR1A was written at the end of the ISR
+
+  update_machine(before);
+  if (block_buffer_tail != tail)
+    check_chord(&block_buffer[tail]);
+}
+
+static void temperature_interrupt()
+{
+  const double dt = HOSTSIM_TIMER0_PERIOD / (double)F_CPU;
+
+  // 40 W hotend block, 200 W bed; heater outputs as the ISR left them
+  temp_hotend += dt * ((output_high(HEATER_0_PIN) ? 40.0 : 0.0) - (temp_hotend - HOSTSIM_AMBIENT) / 9.4) / 12.0;
+  #if defined(HEATER_BED_PIN) && HEATER_BED_PIN > -1
+    temp_bed += dt * ((output_high(HEATER_BED_PIN) ? 200.0 : 0.0) - (temp_bed - HOSTSIM_AMBIENT) / 0.9) / 600.0;
+  #endif
+
+  uint8_t channel = (ADMUX & 0x07) | ((ADCSRB & (1 << MUX5)) ? 8 : 0);
+  double t = HOSTSIM_AMBIENT;
+  if (channel == TEMP_0_PIN)
+    t = temp_hotend;
+  #if defined(TEMP_BED_PIN) && TEMP_BED_PIN > -1
+    else if (channel == TEMP_BED_PIN)
+      t = temp_bed;
+  #endif
+  ADC = (uint16_t)(thermistor_adc(t) + 0.5);
+
+  in_isr = true;
+  TIMER0_COMPB_vect();
+  in_isr = false;
+
+  temp_isrs++;
+  temp_cycles += HOSTSIM_TEMP_ISR_CYCLES;
+  pass(now + HOSTSIM_TEMP_ISR_CYCLES);
+}
+
+// Move the clock forward to t, booking the time for the statistics.
+static void pass(uint64_t t)
+{
+  if (t <= now)
+    return;
+  if (blocks_queued())
+    busy_cycles += t - now;
+  else if (waiting_for_host())
+    starved_cycles += t - now;
+  else if (!input_done)
+    stalled_cycles += t - now;
+  now = t;
+}
+
+// Run whatever interrupts are flagged, in AVR vector priority order.
+static void dispatch()
+{
+  while (interrupts_on()) {
+    if (t1_flag && (TIMSK1 & (1 << OCIE1A))) {
+      t1_flag = false;
+      stepper_interrupt();
+    }
+    else if (t0_flag && (TIMSK0 & (1 << OCIE0B))) {
+      t0_flag = false;
+      temperature_interrupt();
+    }
+    else if ((UCSR0A & (1 << RXC0)) && (UCSR0B & (1 << RXCIE0))) {
+      in_isr = true;
+      USART0_RX_vect();
+      in_isr = false;
+    }
+    else
+      break;
+  }
+}
+
+// Advance the virtual clock, raising every interrupt that comes due and
+// running it unless interrupts are off or we are already inside an ISR.
+static void advance(uint64_t cycles)
+{
+  if (host_scale > 0 && !in_isr) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    if (host_mark)
+      cycles += (uint64_t)((ns - host_mark) * host_scale * (F_CPU / 1e9));
+    host_mark = ns;
+  }
+
+  uint64_t target = now + cycles;
+  polls++;
+  for (;;) {
+    dispatch();
+
+    uint64_t t1 = timer1_due();
+    uint64_t rx = rx_ready() ? rx_next : UINT64_MAX;
+    uint64_t next = t1 < t0_next ? t1 : t0_next;
+    if (rx < next)
+      next = rx;
+    if (next > target)
+      break;
+    pass(next);
+    t1_seen = next;
+
+    if (next == t1) {
+      t1_zero = t1;  // CTC: the counter clears on the match
+      t1_flag = true;
+    }
+    else if (next == t0_next) {
+      t0_next += HOSTSIM_TIMER0_PERIOD;
+      t0_flag = true;
+    }
+    else {
+      UCSR0A.value |= 1 << RXC0;
+      rx_latch = line[line_pos++];
+      bytes_rx++;
+      rx_next = now + byte_cycles();
+      if (line_pos == line_len) {
+        awaiting_ok = true;
+        lines_sent++;
+      }
+    }
+  }
+  pass(target);
+  if (t1_seen < target)
+    t1_seen = target;
+
+  if (limit && now >= limit) {
+    fprintf(stderr, "hostsim: time limit reached\n");
+    report();
+    _exit(1);
+  }
+}
+
+//===========================================================================
+//=============================serial link      ==============================
+//===========================================================================
+
+// Load the next non-empty G-code line from stdin, comments stripped.
+static bool next_line()
+{
+  char buf[256];
+  while (fgets(buf, sizeof(buf), gcode_in ? gcode_in : stdin)) {
+    char *c = strchr(buf, ';');
+    if (c)
+      *c = 0;
+    char *s = buf;
+    while (*s == ' ' || *s == '\t')
+      s++;
+    int n = strlen(s);
+    while (n && (s[n - 1] == '\n' || s[n - 1] == '\r' || s[n - 1] == ' ' || s[n - 1] == '\t'))
+      n--;
+    if (!n)
+      continue;
+    if (n > MAX_CMD_SIZE - 1)
+      n = MAX_CMD_SIZE - 1;
+    memcpy(line, s, n);
+    line[n++] = '\n';
+    line_len = n;
+    line_pos = 0;
+    return true;
+  }
+  return false;
+}
+
+static bool rx_ready()
+{
+  if (!(UCSR0B & (1 << RXEN0)) || (UCSR0A & (1 << RXC0)))
+    return false;
+  if (awaiting_ok || input_done)
+    return false;
+  if (line_pos == line_len && !next_line()) {
+    input_done = true;
+    return false;
+  }
+  if (rx_next < now)
+    rx_next = now;
+  return true;
+}
+
+static void host_receive(uint8_t c)
+{
+  bytes_tx++;
+  #ifdef HOSTSIM_TEST
+    if (output_len < (int)sizeof(output) - 1)
+      output[output_len++] = c;
+  #else
+    if (!quiet)
+      putchar(c);
+  #endif
+  if (c == '\n') {
+    if (reply_len >= 2 && reply[0] == 'o' && reply[1] == 'k') {
+      oks++;
+      awaiting_ok = false;
+    }
+    reply_len = 0;
+  }
+  else if (reply_len < (int)sizeof(reply))
+    reply[reply_len++] = c;
+}
+
+#ifdef HOSTSIM_TEST
+const char *hostsim_output()
+{
+  static char taken[sizeof(output)];
+  memcpy(taken, output, output_len);
+  taken[output_len] = 0;
+  output_len = 0;
+  return taken;
+}
+#endif
+
+hostsim_uart_data::operator uint8_t() const
+{
+  UCSR0A.value &= ~(1 << RXC0);
+  return rx_latch;
+}
+
+hostsim_uart_data &hostsim_uart_data::operator=(uint8_t c)
+{
+  if (tx_free > now)
+    advance(tx_free - now);
+  tx_free = now + byte_cycles();
+  host_receive(c);
+  return *this;
+}
+
+hostsim_timer1_count::operator uint16_t() const
+{
+  unsigned long div = timer1_prescale();
+  return div ? (uint16_t)((now + stepper_isr_elapsed() - t1_zero) / div) : 0;
+}
+
+hostsim_timer1_count &hostsim_timer1_count::operator=(uint16_t v)
+{
+  t1_zero = now - (uint64_t)v * timer1_prescale();
+  t1_seen = now;
+  return *this;
+}
+
+//===========================================================================
+//=============================Arduino core     ==============================
+//===========================================================================
+
+unsigned long millis(void)
+{
+  advance(HOSTSIM_POLL_CYCLES);
+  return now / (F_CPU / 1000);
+}
+
+unsigned long micros(void)
+{
+  advance(HOSTSIM_POLL_CYCLES);
+  return now / (F_CPU / 1000000);
+}
+
+unsigned long hostsim_cpu_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (unsigned long)ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+void delay(unsigned long ms)
+{
+  advance((uint64_t)ms * (F_CPU / 1000));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  advance((uint64_t)us * (F_CPU / 1000000));
+}
+
+void _delay_ms(double ms)
+{
+  advance((uint64_t)(ms * (F_CPU / 1000)));
+}
+
+void _delay_us(double us)
+{
+  advance((uint64_t)(us * (F_CPU / 1000000)));
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  const hostsim_pin &p = pin_map[pin];
+  if (mode == OUTPUT)
+    *p.ddr |= 1 << p.bit;
+  else
+    *p.ddr &= ~(1 << p.bit);
+  if (mode == INPUT_PULLUP)
+    *p.out |= 1 << p.bit;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  const hostsim_pin &p = pin_map[pin];
+  if (val)
+    *p.out |= 1 << p.bit;
+  else
+    *p.out &= ~(1 << p.bit);
+}
+
+int digitalRead(uint8_t pin)
+{
+  if (pin >= NUM_DIGITAL_PINS)
+    return LOW;
+  const hostsim_pin &p = pin_map[pin];
+  return (*p.in & (1 << p.bit)) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+  return (int)thermistor_adc(HOSTSIM_AMBIENT);
+}
+
+void analogWrite(uint8_t pin, int val)
+{
+  digitalWrite(pin, val >= 128);
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode)
+{
+  if (interrupt < 6) {
+    interrupt_handler[interrupt] = handler;
+    interrupt_mode[interrupt] = mode;
+  }
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+  if (interrupt < 6)
+    interrupt_handler[interrupt] = NULL;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+static uint8_t eeprom[E2END + 1];
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+  return eeprom[(uintptr_t)addr & E2END];
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+  eeprom[(uintptr_t)addr & E2END] = value;
+}
+
+//===========================================================================
+//=============================main             ==============================
+//===========================================================================
+
+static void report()
+{
+  double seconds = now / (double)F_CPU;
+  calculate_cartesian(carriage, effector);
+  fflush(stdout);
+  fprintf(stderr, "\n--- hostsim ---\n");
+  fprintf(stderr, "time         %.3f s (%llu cycles)\n", seconds, (unsigned long long)now);
+  fprintf(stderr, "serial       %lu lines, %lu oks, %lu bytes in, %lu bytes out\n",
+          lines_sent, oks, bytes_rx, bytes_tx);
+  fprintf(stderr, "steps        X %lu  Y %lu  Z %lu  E %lu\n",
+          steps[X_AXIS], steps[Y_AXIS], steps[Z_AXIS], steps[E_AXIS]);
+  fprintf(stderr, "stepper ISR  %lu calls (%lu idle), %.1f%% CPU, worst %llu cycles\n",
+          stepper_isrs, stepper_idle_isrs, now ? 100.0 * stepper_cycles / now : 0.0,
+          (unsigned long long)stepper_worst);
+  fprintf(stderr, "temp ISR     %lu calls, %.1f%% CPU\n",
+          temp_isrs, now ? 100.0 * temp_cycles / now : 0.0);
+  fprintf(stderr, "planner      busy %.3f s, ran dry %lu times mid-stream\n", busy_cycles / (double)F_CPU, underruns);
+  fprintf(stderr, "             empty %.3f s waiting on the serial line, %.3f s inside a command\n",
+          starved_cycles / (double)F_CPU, stalled_cycles / (double)F_CPU);
+  fprintf(stderr, "machine      carriages %.3f %.3f %.3f, effector %.3f %.3f %.3f, lowest Z %.3f\n",
+          carriage[X_AXIS], carriage[Y_AXIS], carriage[Z_AXIS],
+          effector[X_AXIS], effector[Y_AXIS], effector[Z_AXIS],
+          deepest < effector[Z_AXIS] ? deepest : effector[Z_AXIS]);
+  fprintf(stderr, "             probe dragged %.3f mm across the bed\n", dragged);
+  fprintf(stderr, "temperature  hotend %.1f C, bed %.1f C\n", temp_hotend, temp_bed);
+  fprintf(stderr, "kinematics   %lu blocks moved every carriage, worst chord error %.4f mm\n", chord_blocks, chord_worst);
+  #ifdef PLANNER_TIMING
+    static const char *name[PLANNER_TIMERS] = {
+      "plan_buffer_line", "planner_recalculate", "calculate_trapezoid_for_block", "delta segment" };
+    unsigned long blocks = planner_timing_blocks ? planner_timing_blocks : 1;
+    const planner_timer_t &line = planner_timing[PLANNER_TIMING_LINE];
+    fprintf(stderr, "planner CPU  %lu blocks (buffer %d), %.0f blocks/s on this host, %.2f junctions and %.2f trapezoids per block\n",
+            planner_timing_blocks, BLOCK_BUFFER_SIZE, line.total ? planner_timing_blocks * 1e9 / line.total : 0.0,
+            planner_timing_junctions / (double)blocks, planner_timing[PLANNER_TIMING_TRAPEZOID].calls / (double)blocks);
+    for (int i = 0; i < PLANNER_TIMERS; i++) {
+      const planner_timer_t &t = planner_timing[i];
+      fprintf(stderr, "             %-30s %8lu calls, avg %8.3f us, max %8.3f us, %8.3f us per block\n", name[i], t.calls,
+              t.calls ? t.total / 1e3 / t.calls : 0.0, t.max / 1e3, t.total / 1e3 / blocks);
+    }
+  #endif
+}
+
+// Power the machine up with blank EEPROM, the carriages below their endstops
+static void power_on()
+{
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  tower_top = MANUAL_Z_HOME_POS + sqrt(sq(DEFAULT_DELTA_DIAGONAL_ROD) - sq(DEFAULT_DELTA_RADIUS));
+  for (int8_t i = 0; i < 3; i++)
+    carriage[i] = tower_top - HOSTSIM_DROP;
+  update_endstops();
+  MCUSR = 1;  // power-on reset
+
+  sei();
+  setup();
+}
+
+// Run the firmware until it has taken all the input and the moves are done
+static void run_until_idle()
+{
+  int idle = 0;
+  while (idle <= BUFSIZE) {
+    loop();
+    if (input_done && !awaiting_ok && !blocks_queued())
+      idle++;
+    else
+      idle = 0;
+  }
+}
+
+#ifdef HOSTSIM_TEST
+void hostsim_start()
+{
+  power_on();
+}
+
+void hostsim_gcode(const char *gcode)
+{
+  gcode_in = fmemopen((void *)gcode, strlen(gcode), "r");
+  input_done = false;
+  run_until_idle();
+  fclose(gcode_in);
+  gcode_in = NULL;
+}
+
+void hostsim_bed(float (*height)(float x, float y))
+{
+  bed_shape = height;
+  bed_contact = effector[Z_AXIS] <= bed_height(effector[X_AXIS], effector[Y_AXIS]);
+  update_endstops();
+}
+
+float hostsim_dragged()
+{
+  float mm = dragged;
+  dragged = 0;
+  return mm;
+}
+#else
+// The firmware spins forever on kill() and other fatal paths; notice
+// when the virtual clock stops moving and bail out.
+static void watchdog(int)
+{
+  static unsigned long last = ~0UL;
+  if (polls == last) {
+    fprintf(stderr, "hostsim: firmware stopped polling the clock\n");
+    report();
+    _exit(2);
+  }
+  last = polls;
+  alarm(5);
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr,
+    "usage: %s [-q] [-t seconds] [-x factor] [-o trace] [-g golden [-T pct] [-S steps]] < file.gcode\n"
+    "       %s -s trace\n"
+    "  -q         do not echo firmware output\n"
+    "  -t sec     stop after this much virtual time\n"
+    "  -x factor  also charge main-line code at factor x host CPU time\n"
+    "  -o trace   write the step stream to a trace file\n"
+    "  -g golden  compare the step stream with a golden trace, exit 3 on a mismatch\n"
+    "  -T pct     allowed difference in block and total durations (default 1)\n"
+    "  -S steps   allowed difference in steps and position per block and axis (default 0)\n"
+    "  -s trace   print the summary of a trace file and exit\n", name, name);
+  exit(1);
+}
+
+int main(int argc, char **argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "qt:x:o:g:T:S:s:")) != -1) {
+    switch (opt) {
+      case 'q': quiet = true; break;
+      case 't': limit = (uint64_t)(atof(optarg) * F_CPU); break;
+      case 'x': host_scale = atof(optarg); break;
+      case 'o': trace_out = optarg; break;
+      case 'g': trace_golden = optarg; break;
+      case 'T': trace_tolerance = atof(optarg); break;
+      case 'S': trace_slack = atol(optarg); break;
+      case 's': _exit(trace_summary_file(optarg) ? 0 : 1);
+      default: usage(argv[0]);
+    }
+  }
+  if (!trace_open(trace_out, HOSTSIM_TRACE_RATE))
+    exit(1);
+
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  signal(SIGALRM, watchdog);
+  alarm(5);
+
+  power_on();
+  run_until_idle();
+  report();
+  trace_close();
+  trace_summary();
+  bool same = !trace_golden || trace_compare(trace_golden, trace_tolerance, trace_slack);
+  fflush(stdout);
+  _exit(same ? 0 : 3);  // like the firmware, never run the static destructors
+}
+#endif // HOSTSIM_TEST
@@ -0,0 +1,26 @@
+/*
+  hostsim.h - the simulator as seen by the host test programs
+
+  Built with HOSTSIM_TEST, hostsim.cpp leaves out main() so that a test
+  program can link the firmware and the simulated ATmega2560 and call
+  firmware functions directly, or power the machine up and feed it
+  G-code.  The clock, EEPROM and serial port work
+  as in the simulator; what the firmware prints is kept for the test
+  instead of being echoed.
+*/
+#ifndef HOSTSIM_H
+#define HOSTSIM_H
+
+// What the firmware printed since the previous call
+const char *hostsim_output();
+
+// Power the machine up and run setup(), for a test that moves it
+void hostsim_start();
+// Feed G-code lines to the firmware and return once they are all done
+void hostsim_gcode(const char *gcode);
+// Shape the bed: its height at x, y (NULL for flat at Z = 0)
+void hostsim_bed(float (*height)(float x, float y));
+// How far the effector moved in X/Y with the probe pressed since the previous call, mm
+float hostsim_dragged();
+
+#endif // HOSTSIM_H
@@ -0,0 +1,63 @@
+#!/bin/sh
+# Delta kinematics comparison: run the bench workloads and check/*.gcode
+# through a reference simulator built with the plain float calculate_delta()
+# and through builds with other kinematics, and check that every block of
+# each variant's step stream is within STEP_SLACK steps (default 1) of the
+# reference's; block durations are not compared. Prints the segments each
+# run planned, the time prepare_move() spent on each (PLANNER_TIMING
+# builds) and the worst chord error: how far a carriage strayed from the
+# height the straight Cartesian path puts it at. The times are host CPU
+# time, where sqrt() is cheap: they rank the variants against each other,
+# not the 16 MHz target.
+#
+#   kinematics.sh ./Marlin.kin ./Marlin.kin-incremental ... [-r ./Marlin.kin-adaptive ...]
+#
+# Variants after -r split moves into a different number of segments, so
+# their step streams cannot be compared block by block; only their figures,
+# chord error included, are reported. Exits 1 if a compared variant is out
+# of tolerance.
+
+usage='usage: kinematics.sh ./reference [./variant ...] [-r ./variant ...]'
+reference=${1:?$usage}
+shift
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+. "$(dirname "$0")/workloads.sh"
+workloads "$dir"
+
+# name, segments, time per segment and worst chord error of one run's statistics
+figures() {
+  awk -v name="$1" '/^kinematics/ { chord = $2 ? $10 " mm" : "n/a" }
+    /^planner CPU/ { blocks = $3 }
+    /delta segment/ { segments = $3; us = $6 }
+    END { printf "%-28s %8d segments, avg %7.3f us per segment, %d blocks, worst chord error %s\n",
+          name, segments, us, blocks, chord }'
+}
+
+failed=0
+for file in "$dir"/*.gcode "$(dirname "$0")"/check/*.gcode; do
+  name=$(basename "$file" .gcode)
+  echo "== $name"
+  "$reference" -q -o "$dir/reference.trc" < "$file" 2>&1 >/dev/null | figures "$(basename "$reference")"
+  compare=1
+  for sim in "$@"; do
+    if [ "$sim" = -r ]; then
+      compare=0
+      continue
+    fi
+    if [ $compare = 1 ]; then
+      "$sim" -q -g "$dir/reference.trc" -S "${STEP_SLACK:-1}" -T 1e9 < "$file" 2>"$dir/stats" >/dev/null
+      status=$?
+      figures "$(basename "$sim")" < "$dir/stats"
+      if [ $status -ne 0 ]; then
+        grep '^trace:' "$dir/stats"
+        echo "FAIL $(basename "$sim") on $name: exit status $status"
+        failed=1
+      fi
+    else
+      "$sim" -q < "$file" 2>&1 >/dev/null | figures "$(basename "$sim")"
+    fi
+  done
+done
+exit $failed
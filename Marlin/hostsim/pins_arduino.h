@@ -0,0 +1,3 @@
+/*
+  pins_arduino.h - empty stand-in for the host simulation build
+*/
@@ -0,0 +1,6 @@
+/*
+  stdio.h - keeps the C library's fpos_t out of the way of SdBaseFile's
+*/
+#define fpos_t hostsim_fpos_t
+#include_next <stdio.h>
+#undef fpos_t
@@ -0,0 +1,111 @@
+/*
+  bench_bed_level.cpp - host CPU time per call of bed_level_offset() on a
+  loaded 7x7 mesh, against the divide-and-floor interpolation it replaced.
+
+  The points are the segment ends of print moves across the bed, half a
+  millimetre apart as prepare_move() makes them at print speeds, so most
+  calls stay in the cached cell; and the same points shuffled, so nearly
+  every call changes cell.  Like bench.sh the figures are host CPU time:
+  they compare the two with each other, not with the 16 MHz target.
+  make bench builds and runs it.
+*/
+#include <stdio.h>
+#include <unistd.h>
+#include "Marlin.h"
+
+#define POINTS 200000
+#define ROUNDS 20
+
+static float points[POINTS][3];
+
+// adjust_delta()'s interpolation before the cell cache: divide by the grid spacing,
+// floor() and the four bed_level points every call
+__attribute__((noinline)) static float bed_level_offset_divide(float cartesian[3])
+{
+  int half = (AUTO_BED_LEVELING_GRID_POINTS - 1) / 2;
+  float grid_x = max(0.001-half, min(half-0.001, cartesian[X_AXIS] / AUTO_BED_LEVELING_GRID_X));
+  float grid_y = max(0.001-half, min(half-0.001, cartesian[Y_AXIS] / AUTO_BED_LEVELING_GRID_Y));
+  int floor_x = floor(grid_x);
+  int floor_y = floor(grid_y);
+  float ratio_x = grid_x - floor_x;
+  float ratio_y = grid_y - floor_y;
+  float z1 = bed_level[floor_x+half][floor_y+half];
+  float z2 = bed_level[floor_x+half][floor_y+half+1];
+  float z3 = bed_level[floor_x+half+1][floor_y+half];
+  float z4 = bed_level[floor_x+half+1][floor_y+half+1];
+  float left = (1-ratio_y)*z1 + ratio_y*z2;
+  float right = (1-ratio_y)*z3 + ratio_y*z4;
+  return (1-ratio_x)*left + ratio_x*right;
+}
+
+// Host CPU ns per call of offset() over all the points
+static double time_per_call(float (*offset)(float cartesian[3]))
+{
+  volatile float sink = 0;
+  unsigned long started = hostsim_cpu_ns();
+  for (int r = 0; r < ROUNDS; r++)
+    for (int i = 0; i < POINTS; i++)
+      sink = sink + offset(points[i]);
+  return (hostsim_cpu_ns() - started) / ((double)ROUNDS * POINTS);
+}
+
+// Returns false when the two disagree
+static bool run(const char *name)
+{
+  float worst = 0;
+  bed_level_updated();
+  for (int i = 0; i < POINTS; i++) {
+    float d = fabs(bed_level_offset(points[i]) - bed_level_offset_divide(points[i]));
+    if (d > worst) worst = d;
+  }
+  double divide = time_per_call(bed_level_offset_divide);
+  bed_level_updated();
+  double cached = time_per_call(bed_level_offset);
+  printf("%-16s divide/floor %6.2f ns per call, cached cell %6.2f ns per call (%.2fx), largest difference %.1e mm\n",
+         name, divide, cached, divide / cached, worst);
+  return worst < 1e-5;
+}
+
+int main()
+{
+  // A bed with a different height at every bed_level point
+  for (int x = 0; x < AUTO_BED_LEVELING_GRID_POINTS; x++)
+    for (int y = 0; y < AUTO_BED_LEVELING_GRID_POINTS; y++)
+      bed_level[x][y] = 0.05 * ((x * 7 + y * 3) % 5) - 0.1 + 0.01 * x * y;
+
+  // Moves between random points of the printable disc, 0.5 mm segments
+  unsigned long seed = 1;
+  float x = 0, y = 0;
+  for (int i = 0; i < POINTS; ) {
+    float to_x, to_y;
+    do {
+      seed = seed * 1103515245 + 12345;
+      to_x = (int((seed >> 8) % 2000) - 1000) * (DELTA_PRINTABLE_RADIUS / 1000.0);
+      seed = seed * 1103515245 + 12345;
+      to_y = (int((seed >> 8) % 2000) - 1000) * (DELTA_PRINTABLE_RADIUS / 1000.0);
+    } while (sq(to_x) + sq(to_y) > sq(DELTA_PRINTABLE_RADIUS));
+    int segments = max(1, int(sqrt(sq(to_x - x) + sq(to_y - y)) / 0.5));
+    for (int s = 1; s <= segments && i < POINTS; s++, i++) {
+      points[i][X_AXIS] = x + (to_x - x) * s / segments;
+      points[i][Y_AXIS] = y + (to_y - y) * s / segments;
+      points[i][Z_AXIS] = 0.3;
+    }
+    x = to_x;
+    y = to_y;
+  }
+  bool same = run("along segments");
+
+  for (int i = POINTS - 1; i > 0; i--) {
+    seed = seed * 1103515245 + 12345;
+    int j = (seed >> 8) % (i + 1);
+    for (int k = 0; k < 3; k++) {
+      float t = points[i][k];
+      points[i][k] = points[j][k];
+      points[j][k] = t;
+    }
+  }
+  same &= run("scattered");
+
+  fflush(stdout);
+  _exit(same ? 0 : 1);  // like the simulator, never run the static destructors
+}
@@ -0,0 +1,64 @@
+/*
+  test.h - checks for the host test programs
+
+  Each tests/test_*.cpp is a program of its own, linked with the firmware
+  and the simulator (see hostsim.h). A failed check prints where it was
+  and the program goes on; test_done() prints the tally and gives the
+  exit status.
+*/
+#ifndef HOSTSIM_TEST_H
+#define HOSTSIM_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+static int test_checks, test_failures;
+
+#define CHECK(cond) test_check((cond), #cond, __FILE__, __LINE__)
+#define CHECK_NEAR(value, expected, tolerance) \
+  test_near((value), (expected), (tolerance), #value, __FILE__, __LINE__)
+
+static bool test_check(bool ok, const char *what, const char *file, int line)
+{
+  test_checks++;
+  if (!ok) {
+    test_failures++;
+    printf("%s:%d: check failed: %s\n", file, line, what);
+  }
+  return ok;
+}
+
+static bool test_near(double value, double expected, double tolerance, const char *what,
+                      const char *file, int line)
+{
+  test_checks++;
+  if (fabs(value - expected) > tolerance || value != value) {
+    test_failures++;
+    printf("%s:%d: %s is %g, expected %g +- %g\n", file, line, what, value, expected, tolerance);
+    return false;
+  }
+  return true;
+}
+
+static unsigned long noise_seed = 1;
+
+// Repeatable numbers in [-1, 1), the same run after run
+static inline double noise()
+{
+  noise_seed = noise_seed * 1103515245 + 12345;
+  return ((noise_seed >> 8) & 0xFFFF) / 32768.0 - 1;
+}
+
+static int test_done(const char *name)
+{
+  printf("%s %s: %d checks", test_failures ? "FAIL" : "PASS", name, test_checks);
+  if (test_failures)
+    printf(", %d failed", test_failures);
+  printf("\n");
+  fflush(stdout);
+  _exit(test_failures ? 1 : 0);  // like the simulator, never run the static destructors
+}
+
+#endif // HOSTSIM_TEST_H
@@ -0,0 +1,173 @@
+/*
+  test_delta_kinematics.cpp - the shortcuts prepare_move() takes on the way
+  to the carriage heights of each move segment: the incremental kinematics
+  and the adaptive segment count against calculate_delta(), and the cached
+  bed_level cell of bed_level_offset() against a fresh interpolation.
+  make kinematics covers the fixed-point kinematics, which need a build of
+  their own.
+*/
+#include "Marlin.h"
+#include "ConfigurationStore.h"
+#include "planner.h"
+#include "../hostsim.h"
+#include "test.h"
+
+// Moves across the bed, and ones that pass close to a tower where the carriage paths bend most
+static const float moves[][4] = {
+  // start x, y, end x, y
+  { -80, -80, 80, 80 },
+  { 0, 0, 0, 85 },
+  { -90, 20, 90, 20 },
+  { -60, -70, -5, 80 },
+  { 85, 0, -85, 0 },
+  { -70, -40, 70, -45 },
+};
+#define MOVES (sizeof(moves) / sizeof(moves[0]))
+
+static void segment_end(const float move[4], float z, int segment, int segments, float cartesian[3])
+{
+  float fraction = float(segment) / segments;
+  cartesian[X_AXIS] = move[0] + (move[2] - move[0]) * fraction;
+  cartesian[Y_AXIS] = move[1] + (move[3] - move[1]) * fraction;
+  cartesian[Z_AXIS] = z;
+}
+
+// calculate_delta_incremental() for every segment of every move, in prepare_move()'s order:
+// every carriage height within DELTA_INCREMENTAL_TOLERANCE of calculate_delta(), the
+// resynchronised segments exact. Returns the worst error in mm.
+static float check_incremental(int segments, float z)
+{
+  float worst = 0;
+  for (unsigned m = 0; m < MOVES; m++) {
+    float difference[3] = { moves[m][2] - moves[m][0], moves[m][3] - moves[m][1], 0 };
+    calculate_delta_incremental_start(difference, segments);
+    for (int s = 1; s <= segments; s++) {
+      float cartesian[3], incremental[3];
+      segment_end(moves[m], z, s, segments, cartesian);
+      calculate_delta_incremental(cartesian, s, segments);
+      memcpy(incremental, delta, sizeof(incremental));
+      calculate_delta(cartesian);
+      for (int i = 0; i < 3; i++) {
+        float error = fabs(incremental[i] - delta[i]);
+        if (error > worst) worst = error;
+        // float carries about 3e-5 mm at these heights
+        if (!CHECK_NEAR(incremental[i], delta[i], DELTA_INCREMENTAL_TOLERANCE + 1e-4)
+            || ((s == 1 || s == segments || s % DELTA_INCREMENTAL_RESYNC == 0) && !CHECK_NEAR(incremental[i], delta[i], 1e-4)))
+          printf("  move %u, segment %d of %d, tower %d\n", m, s, segments, i + 1);
+      }
+    }
+  }
+  return worst;
+}
+
+// Largest distance between a carriage's path along a move and the chords of the move split
+// into the given number of segments
+static float chord_error(const float move[4], int segments)
+{
+  float worst = 0;
+  for (int s = 1; s <= segments; s++) {
+    float start[3], end[3], carriage_start[3];
+    segment_end(move, 0, s - 1, segments, start);
+    segment_end(move, 0, s, segments, end);
+    calculate_delta(start);
+    memcpy(carriage_start, delta, sizeof(carriage_start));
+    calculate_delta(end);
+    float carriage_end[3];
+    memcpy(carriage_end, delta, sizeof(carriage_end));
+    for (int k = 1; k < 8; k++) {
+      float point[3];
+      segment_end(move, 0, (s - 1) * 8 + k, segments * 8, point);
+      calculate_delta(point);
+      for (int i = 0; i < 3; i++)
+        worst = max(worst, fabs(delta[i] - (carriage_start[i] + (carriage_end[i] - carriage_start[i]) * k / 8)));
+    }
+  }
+  return worst;
+}
+
+// delta_segments_for_error() keeps every carriage within DELTA_SEGMENT_MAX_ERROR of its path,
+// and asks for no more than about twice the segments that needs
+static void check_adaptive(const float move[4])
+{
+  float start[3] = { move[0], move[1], 0 };
+  float difference[3] = { move[2] - move[0], move[3] - move[1], 0 };
+  int segments = delta_segments_for_error(start, difference);
+  float error = chord_error(move, segments);
+  if (!CHECK(error <= DELTA_SEGMENT_MAX_ERROR + 1e-4))
+    printf("  %d segments from %g,%g to %g,%g: %.4f mm off the path\n", segments, move[0], move[1], move[2], move[3], error);
+  // Fewer segments for the path error alone when the bed_level cells ask for more
+  float cell = sqrt(sq(difference[X_AXIS]) + sq(difference[Y_AXIS])) / AUTO_BED_LEVELING_GRID_X;
+  if (segments > ceil(cell) && segments > 1 && !CHECK(chord_error(move, segments / 2) > DELTA_SEGMENT_MAX_ERROR))
+    printf("  %d segments from %g,%g to %g,%g: half as many would do\n", segments, move[0], move[1], move[2], move[3]);
+}
+
+// bed_level_offset() worked out afresh: bilinear between the four bed_level points around
+// x, y, clamped to the outer cells
+static double bed_level_bilinear(float x, float y)
+{
+  int half = (AUTO_BED_LEVELING_GRID_POINTS - 1) / 2;
+  double gx = max(0.0, min(2.0 * half, x / (double)AUTO_BED_LEVELING_GRID_X + half));
+  double gy = max(0.0, min(2.0 * half, y / (double)AUTO_BED_LEVELING_GRID_Y + half));
+  int cx = min(2 * half - 1, int(gx)), cy = min(2 * half - 1, int(gy));
+  double fx = gx - cx, fy = gy - cy;
+  return (1 - fx) * (1 - fy) * bed_level[cx][cy] + fx * (1 - fy) * bed_level[cx + 1][cy]
+         + (1 - fx) * fy * bed_level[cx][cy + 1] + fx * fy * bed_level[cx + 1][cy + 1];
+}
+
+// bed_level_offset() along the segments of every move, so consecutive calls mostly hit the
+// cached cell, against the fresh interpolation
+static void check_bed_level_offset(int segments)
+{
+  for (unsigned m = 0; m < MOVES; m++) {
+    for (int s = 0; s <= segments; s++) {
+      float cartesian[3];
+      segment_end(moves[m], 0.3, s, segments, cartesian);
+      if (!CHECK_NEAR(bed_level_offset(cartesian), bed_level_bilinear(cartesian[X_AXIS], cartesian[Y_AXIS]), 1e-5))
+        printf("  move %u, segment %d of %d at %g,%g\n", m, s, segments, cartesian[X_AXIS], cartesian[Y_AXIS]);
+    }
+  }
+}
+
+int main()
+{
+  Config_ResetDefault();
+  hostsim_output();
+
+  static const int segments[] = { 1, 2, 3, 15, 16, 17, 40, 160, 500 };
+  for (unsigned i = 0; i < sizeof(segments) / sizeof(segments[0]); i++) {
+    check_incremental(segments[i], 0.3);
+    check_incremental(segments[i], 150);
+  }
+  // Well inside a step at the default steps per unit
+  CHECK(check_incremental(160, 0.3) * axis_steps_per_unit[X_AXIS] < 0.1);
+
+  for (unsigned m = 0; m < MOVES; m++)
+    check_adaptive(moves[m]);
+  // Short moves near the edge of the bed, where a carriage's path is most curved
+  for (int a = 0; a < 360; a += 15) {
+    float x = 85 * cos(a * PI / 180), y = 85 * sin(a * PI / 180);
+    const float move[4] = { x, y, float(x + 6 * sin(a * PI / 180)), float(y - 6 * cos(a * PI / 180)) };
+    check_adaptive(move);
+  }
+
+  // A bed with a different height at every bed_level point
+  for (int x = 0; x < AUTO_BED_LEVELING_GRID_POINTS; x++)
+    for (int y = 0; y < AUTO_BED_LEVELING_GRID_POINTS; y++)
+      bed_level[x][y] = 0.05 * ((x * 7 + y * 3) % 5) - 0.1 + 0.01 * x * y;
+  bed_level_updated();
+  check_bed_level_offset(1);
+  check_bed_level_offset(40);
+  check_bed_level_offset(500);
+  // Off the grid: held at the height of the outer cells' edge
+  float corner[3] = { 200, -200, 0 };
+  CHECK_NEAR(bed_level_offset(corner), bed_level[AUTO_BED_LEVELING_GRID_POINTS - 1][0], 1e-3);
+  // A new mesh drops the cached cell
+  float centre[3] = { 1, 1, 0 };
+  bed_level_offset(centre);
+  bed_level[AUTO_BED_LEVELING_GRID_POINTS / 2][AUTO_BED_LEVELING_GRID_POINTS / 2] += 0.5;
+  bed_level_updated();
+  CHECK_NEAR(bed_level_offset(centre), bed_level_bilinear(1, 1), 1e-5);
+  check_bed_level_offset(40);
+
+  return test_done("delta_kinematics");
+}
@@ -0,0 +1,150 @@
+/*
+  test_eeprom_mesh.cpp - Config_StoreMesh() and Config_RetrieveMesh()
+  through the emulated EEPROM: a round trip, corrupted bytes, a mesh
+  stored by a firmware with another layout and the settings stored after it.
+*/
+#include "Marlin.h"
+#include "ConfigurationStore.h"
+#include "../hostsim.h"
+#include "test.h"
+
+// The stored mesh, as laid out by ConfigurationStore.cpp
+#define MESH_OFFSET 1024              // EEPROM_MESH_OFFSET
+#define MESH_LAYOUT (MESH_OFFSET + 4)  // after the version
+#define MESH_HEIGHTS (MESH_LAYOUT + 3)
+#define N AUTO_BED_LEVELING_GRID_POINTS
+
+static uint16_t crc16(int pos, int end)
+{
+  uint16_t crc = 0xFFFF;
+  for (; pos < end; pos++) {
+    crc ^= uint16_t(eeprom_read_byte((uint8_t *)(uintptr_t)pos)) << 8;
+    for (int bit = 0; bit < 8; bit++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+static void write_bytes(int pos, const void *data, int size)
+{
+  for (int i = 0; i < size; i++)
+    eeprom_write_byte((uint8_t *)(uintptr_t)(pos + i), ((const uint8_t *)data)[i]);
+}
+
+static uint8_t read_byte(int pos)
+{
+  return eeprom_read_byte((uint8_t *)(uintptr_t)pos);
+}
+
+static void fill_mesh(float base)
+{
+  for (int x = 0; x < N; x++)
+    for (int y = 0; y < N; y++)
+      bed_level[x][y] = base + 0.013 * x - 0.007 * y + 0.001 * x * y;
+}
+
+static bool mesh_is(float base)
+{
+  for (int x = 0; x < N; x++)
+    for (int y = 0; y < N; y++)
+      if (bed_level[x][y] != float(base + 0.013 * x - 0.007 * y + 0.001 * x * y))
+        return false;
+  return true;
+}
+
+// A version M01 mesh as a firmware with rows x columns points (or a polar mesh) would store it
+static void store_foreign_mesh(uint8_t polar, uint8_t rows, uint8_t columns)
+{
+  const uint8_t layout[3] = { polar, rows, columns };
+  int i = MESH_LAYOUT;
+  write_bytes(MESH_OFFSET, "M01", 4);
+  write_bytes(i, layout, 3);
+  i += 3;
+  for (int k = 0; k < rows * columns + polar; k++, i += 4) {
+    float z = 0.01 * k;
+    write_bytes(i, &z, 4);
+  }
+  uint8_t subdivision = 1;
+  write_bytes(i++, &subdivision, 1);
+  uint16_t crc = crc16(MESH_LAYOUT, i);
+  write_bytes(i, &crc, 2);
+}
+
+int main()
+{
+  // Blank EEPROM
+  for (int i = MESH_OFFSET; i < MESH_OFFSET + 256; i++)
+    eeprom_write_byte((uint8_t *)(uintptr_t)i, 0xFF);
+  fill_mesh(1.0);
+  CHECK(!Config_RetrieveMesh());
+  CHECK(strstr(hostsim_output(), "No stored mesh"));
+  CHECK(mesh_is(1.0));
+
+  // Store, read back, compare
+  fill_mesh(0.25);
+  Config_StoreMesh();
+  CHECK(strstr(hostsim_output(), "Mesh Stored"));
+  CHECK(read_byte(MESH_OFFSET) == 'M' && read_byte(MESH_OFFSET + 1) == '0' && read_byte(MESH_OFFSET + 2) == '1');
+  CHECK(read_byte(MESH_LAYOUT) == 0 && read_byte(MESH_LAYOUT + 1) == N && read_byte(MESH_LAYOUT + 2) == N);
+  int end = MESH_HEIGHTS + sizeof(bed_level) + 1;
+  CHECK(crc16(MESH_LAYOUT, end) == (read_byte(end) | read_byte(end + 1) << 8));
+
+  fill_mesh(-3.0);
+  CHECK(Config_RetrieveMesh());
+  CHECK(strstr(hostsim_output(), "Stored mesh retrieved"));
+  CHECK(mesh_is(0.25));
+
+  // Any corrupted byte after the layout (heights, subdivision, CRC) is caught and the mesh kept
+  int corrupted[] = { MESH_HEIGHTS, MESH_HEIGHTS + 97, end - 2, end - 1, end, end + 1 };
+  for (unsigned k = 0; k < sizeof(corrupted) / sizeof(corrupted[0]); k++) {
+    int pos = corrupted[k];
+    uint8_t good = read_byte(pos);
+    eeprom_write_byte((uint8_t *)(uintptr_t)pos, good ^ 0x10);
+    fill_mesh(-3.0);
+    if (!CHECK(!Config_RetrieveMesh()))
+      printf("  corrupted byte at %d was not caught\n", pos);
+    CHECK(strstr(hostsim_output(), "Stored mesh CRC mismatch"));
+    CHECK(mesh_is(-3.0));
+    eeprom_write_byte((uint8_t *)(uintptr_t)pos, good);
+  }
+  CHECK(Config_RetrieveMesh());
+  CHECK(mesh_is(0.25));
+  hostsim_output();
+
+  // A valid mesh of another layout is refused, not read as this one
+  store_foreign_mesh(0, 5, 5);
+  fill_mesh(-3.0);
+  CHECK(!Config_RetrieveMesh());
+  CHECK(strstr(hostsim_output(), "No stored mesh"));
+  CHECK(mesh_is(-3.0));
+
+  store_foreign_mesh(1, 3, 12);
+  CHECK(!Config_RetrieveMesh());
+  CHECK(strstr(hostsim_output(), "No stored mesh"));
+  CHECK(mesh_is(-3.0));
+
+  // This firmware's own layout written the same way is accepted, so the refusals above are the layout's
+  store_foreign_mesh(0, N, N);
+  CHECK(Config_RetrieveMesh());
+  CHECK(bed_level[0][0] == 0.0f && bed_level[0][1] == 0.01f && bed_level[1][0] == float(0.01 * N));
+
+  // The settings end before the mesh: storing them leaves it loadable
+  fill_mesh(0.75);
+  Config_StoreMesh();
+  hostsim_output();
+  Config_StoreSettings();
+  CHECK(!strstr(hostsim_output(), "overrun"));
+  fill_mesh(-3.0);
+  CHECK(Config_RetrieveMesh());
+  CHECK(mesh_is(0.75));
+
+  // An older mesh version is refused
+  fill_mesh(0.5);
+  Config_StoreMesh();
+  write_bytes(MESH_OFFSET, "M00", 4);
+  fill_mesh(-3.0);
+  CHECK(!Config_RetrieveMesh());
+  CHECK(mesh_is(-3.0));
+
+  return test_done("eeprom_mesh");
+}
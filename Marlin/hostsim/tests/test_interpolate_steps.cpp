@@ -0,0 +1,102 @@
+/*
+  test_interpolate_steps.cpp - st_interpolate_steps(), which places the probe
+  trigger between the step events of the stepper ISR.
+
+  A probe move is stepped the way the stepper ISR does it (Bresenham, step_loops
+  events per interrupt, a fixed interrupt interval) and triggered at many
+  moments. The step counts of the last interrupt plus the interpolation must
+  land on the straight-line position at the trigger: exactly on the axis that
+  leads the block, within the Bresenham rounding of one step on the others.
+  A trigger further from where the carriages stopped than the endstop
+  overshoot, such as a bounce at the start of a re-tap, is refused.
+*/
+#include "Marlin.h"
+#include "stepper.h"
+#include "test.h"
+
+// Step counts after the first 'events' step events of a block, as the ISR's Bresenham makes them
+static void bresenham(const long steps[3], long step_events, long events, long counts[3])
+{
+  for (int i = 0; i < 3; i++) {
+    long counter = -(step_events >> 1);
+    counts[i] = 0;
+    for (long e = 0; e < events; e++) {
+      counter += steps[i];
+      if (counter > 0) {
+        counter -= step_events;
+        counts[i]++;
+      }
+    }
+  }
+}
+
+// Worst error against the straight line, with and without the interpolation, over triggers
+// spread across the block; the axes the block leads and the ones it does not are kept apart.
+static void trigger_errors(const long steps[3], uint8_t loops, unsigned short interval,
+                           float *lead_plain, float *lead_interp, float *other_interp)
+{
+  long step_events = max(steps[0], max(steps[1], steps[2]));
+  *lead_plain = *lead_interp = *other_interp = 0;
+  for (long t = 0; t < (step_events / loops - 1) * (long)interval; t += interval / 7 + 3) {
+    long isrs = t / interval;  // interrupts that have run, the first at t = 0
+    unsigned short elapsed = t - isrs * interval;
+    long counts[3];
+    bresenham(steps, step_events, (isrs + 1) * loops, counts);
+    for (int i = 0; i < 3; i++) {
+      // events run from one interrupt to the next, so the line is at this many events
+      float ideal = ((isrs + 1) * loops + (float)elapsed / interval * loops) * steps[i] / step_events;
+      float plain = fabs(counts[i] - ideal);
+      float interp = fabs(counts[i] + st_interpolate_steps(elapsed, interval, loops, steps[i], step_events) - ideal);
+      if (steps[i] == step_events) {
+        *lead_plain = max(*lead_plain, plain);
+        *lead_interp = max(*lead_interp, interp);
+      }
+      else
+        *other_interp = max(*other_interp, interp);
+    }
+  }
+}
+
+int main()
+{
+  // The function itself
+  CHECK_NEAR(st_interpolate_steps(0, 200, 1, 100, 100), 0, 1e-6);
+  CHECK_NEAR(st_interpolate_steps(100, 200, 1, 100, 100), 0.5, 1e-6);
+  CHECK_NEAR(st_interpolate_steps(200, 200, 2, 100, 100), 2, 1e-6);
+  CHECK_NEAR(st_interpolate_steps(50, 200, 4, 50, 100), 0.5, 1e-6);
+  CHECK_NEAR(st_interpolate_steps(300, 200, 1, 100, 100), 1, 1e-6);  // a late read is one interval at most
+  CHECK_NEAR(st_interpolate_steps(100, 0, 1, 100, 100), 0, 1e-6);
+  CHECK_NEAR(st_interpolate_steps(100, 200, 1, 100, 0), 0, 1e-6);
+
+  // Probe moves: straight down at the centre, and off-centre where the carriages differ
+  static const long moves[][3] = { { 1600, 1600, 1600 }, { 1580, 1600, 1431 }, { 977, 1204, 1600 } };
+  static const uint8_t loops[] = { 1, 2, 4 };
+  for (unsigned m = 0; m < sizeof(moves) / sizeof(moves[0]); m++) {
+    for (unsigned l = 0; l < sizeof(loops) / sizeof(loops[0]); l++) {
+      float lead_plain, lead_interp, other_interp;
+      trigger_errors(moves[m], loops[l], 2000, &lead_plain, &lead_interp, &other_interp);
+      // Without the interpolation the leading axis is up to step_loops steps out
+      CHECK(lead_plain > loops[l] - 0.1);
+      if (!CHECK(lead_interp < 0.001))
+        printf("  move %u, %d loops: leading axis %.4f steps out\n", m, loops[l], lead_interp);
+      // The others keep the Bresenham rounding of the interrupt's counts, one step at most
+      if (!CHECK(other_interp < 1.001))
+        printf("  move %u, %d loops: led axis %.4f steps out\n", m, loops[l], other_interp);
+    }
+  }
+
+  // A trigger within the endstop overshoot of the stop is taken: two interrupts and a step event
+  // past it, plus a step of rounding
+  long stop[3] = { 10000, 10400, 9800 };
+  float near[3] = { 10000.5, 10403, 9796 };
+  CHECK(st_probe_trigger_plausible(near, stop, 1));
+  float far[3] = { 10000, 10406, 9800 };
+  CHECK(!st_probe_trigger_plausible(far, stop, 1));
+  CHECK(st_probe_trigger_plausible(far, stop, 2));
+  // A bounce just after the PROBE_SAMPLE_LIFT of a re-tap is a whole lift above the stop
+  float lift = PROBE_RETAP_BACKOFF * XYZ_STEPS;
+  float bounce[3] = { stop[0] + lift, stop[1] + lift, stop[2] + lift };
+  CHECK(!st_probe_trigger_plausible(bounce, stop, 4));
+
+  return test_done("interpolate_steps");
+}
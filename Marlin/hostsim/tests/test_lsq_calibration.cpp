@@ -0,0 +1,100 @@
+/*
+  test_lsq_calibration.cpp - delta_lsq_fit() on probe data from a machine
+  whose real geometry is off from what the firmware believes: the fit must
+  find the errors it is given factors for, and leave the machine's own
+  geometry alone.
+*/
+#include "Marlin.h"
+#include "ConfigurationStore.h"
+#include "../hostsim.h"
+#include "test.h"
+
+#define POINTS DELTA_CALIBRATION_POINTS
+#define BED_RADIUS 70
+
+static float carriage[POINTS][3], probe_z[POINTS];
+
+// Probe the G30 L points on a flat bed with a machine that is off by p (endstop offsets,
+// delta radius, tower A/B angles, diagonal rod): the carriage heights at which the nozzle
+// touches Z=0, and the height the firmware's geometry puts the nozzle at for them.
+static void probe_machine(const float p[7])
+{
+  float radius = delta_radius, adj_a = tower_adj[0], adj_b = tower_adj[1], rod = delta_diagonal_rod;
+  for (int k = 0; k < POINTS; k++) {
+    float r = k == 0 ? 0 : k <= 6 ? BED_RADIUS : BED_RADIUS / 2;
+    float angle = (k <= 6 ? 90 + (k - 1) * 60 : 120 + (k - 7) * 60) * PI / 180;
+    float contact[3] = { r * cos(angle), r * sin(angle), 0 };
+    delta_radius = radius + p[3];
+    tower_adj[0] = adj_a + p[4];
+    tower_adj[1] = adj_b + p[5];
+    delta_diagonal_rod = rod + p[6];
+    set_delta_constants();
+    calculate_delta(contact);
+    for (int i = 0; i < 3; i++) carriage[k][i] = delta[i] + p[i];
+    delta_radius = radius;
+    tower_adj[0] = adj_a;
+    tower_adj[1] = adj_b;
+    delta_diagonal_rod = rod;
+    set_delta_constants();
+    float believed[3];
+    calculate_cartesian(carriage[k], believed);
+    probe_z[k] = believed[Z_AXIS];
+  }
+}
+
+static float rms(const float *z, int n)
+{
+  float sum = 0;
+  for (int k = 0; k < n; k++) sum += sq(z[k]);
+  return sqrt(sum / n);
+}
+
+// Fit with the given factors; the errors they cover must come back within tolerance
+static float check_fit(const float truth[7], int factors, float tolerance)
+{
+  probe_machine(truth);
+  float p[7];
+  float expected = delta_lsq_fit(carriage, probe_z, POINTS, factors, p);
+  for (int j = 0; j < factors; j++) {
+    if (!CHECK_NEAR(p[j], truth[j], tolerance))
+      printf("  %d factors: p[%d]\n", factors, j);
+  }
+  for (int j = factors; j < 7; j++) CHECK(p[j] == 0);
+  return expected;
+}
+
+int main()
+{
+  Config_ResetDefault();
+  hostsim_output();
+  float tower1_x = delta_tower1_x, tower3_y = delta_tower3_y, radius = delta_radius;
+  float endstop_x = endstop_adj[X_AXIS];
+
+  static const float endstops[7] = { -0.3, 0.2, -0.15, 0, 0, 0, 0 };
+  static const float radius_off[7] = { -0.3, 0.2, -0.15, 0.8, 0, 0, 0 };
+  static const float angles_off[7] = { -0.3, 0.2, -0.15, 0.8, 0.3, -0.2, 0 };
+  static const float rod_off[7] = { -0.3, 0.2, -0.15, 0.8, 0.3, -0.2, 1.0 };
+
+  // What the probing sees before any fit
+  probe_machine(angles_off);
+  float probed = rms(probe_z, POINTS);
+  CHECK(probed > 0.1);
+
+  CHECK(check_fit(endstops, 3, 0.001) < 0.001);
+  CHECK(check_fit(radius_off, 4, 0.001) < 0.001);
+  CHECK(check_fit(angles_off, 6, 0.001) < 0.001);
+  // The rod and the radius bend a flat bed much alike; the two rings still tell them apart
+  CHECK(check_fit(rod_off, 7, 0.002) < 0.001);
+
+  // Too few factors for the errors: the fit does what it can and says so
+  probe_machine(angles_off);
+  float p[7];
+  float left = delta_lsq_fit(carriage, probe_z, POINTS, 3, p);
+  CHECK(left > 0.01 && left < probed);
+
+  // The machine's geometry is as it was
+  CHECK(delta_tower1_x == tower1_x && delta_tower3_y == tower3_y);
+  CHECK(delta_radius == radius && endstop_adj[X_AXIS] == endstop_x);
+
+  return test_done("lsq_calibration");
+}
@@ -0,0 +1,108 @@
+/*
+  test_plane_fit.cpp - the streaming plane_fit that G29 uses, against the
+  qr_solve() least squares it replaced, on the same points.
+*/
+#include "Marlin.h"
+#include "qr_solve.h"
+#include "test.h"
+
+#define N AUTO_BED_LEVELING_GRID_POINTS
+#define MAX_POINTS (N * N)
+
+// The fit as G29 used to make it: qr_solve() over rows x, y, 1
+static void qr_plane(const double *x, const double *y, const double *z, int n, double coefficients[3])
+{
+  double a[MAX_POINTS * 3], b[MAX_POINTS];
+  for (int k = 0; k < n; k++) {
+    a[k] = x[k];
+    a[k + n] = y[k];
+    a[k + 2 * n] = 1;
+    b[k] = z[k];
+  }
+  double *solution = qr_solve(n, 3, a, b);
+  memcpy(coefficients, solution, 3 * sizeof(double));
+  free(solution);
+}
+
+// The probe points of a G29 grid that a delta reaches, with a tilted, noisy bed under them.
+// Returns how many there are.
+static int grid_points(double *x, double *y, double *z, double offset, double tilt)
+{
+  double a = tilt * noise(), b = tilt * noise(), d = noise();
+  int n = 0;
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      double px = LEFT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_X * i;
+      double py = FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * j;
+      if (sq(px) + sq(py) > sq(DELTA_PROBABLE_RADIUS)) continue;
+      x[n] = px + offset;
+      y[n] = py + offset;
+      z[n] = a * x[n] + b * y[n] + d + 0.02 * noise();
+      n++;
+    }
+  }
+  return n;
+}
+
+int main()
+{
+  double x[MAX_POINTS], y[MAX_POINTS], z[MAX_POINTS];
+  double fit[3], qr[3];
+  plane_fit plane;
+
+  // Random point sets: a prefix of a shuffled grid, solved after every point as G29 could
+  double worst = 0;
+  for (int set = 0; set < 200; set++) {
+    int n = grid_points(x, y, z, 0, 0.01);
+    for (int k = n - 1; k > 0; k--) {
+      int other = int((noise() + 1) / 2 * (k + 1)) % (k + 1);
+      double t;
+      t = x[k]; x[k] = x[other]; x[other] = t;
+      t = y[k]; y[k] = y[other]; y[other] = t;
+      t = z[k]; z[k] = z[other]; z[other] = t;
+    }
+    plane.reset();
+    for (int k = 0; k < n; k++) {
+      plane.add(x[k], y[k], z[k]);
+      if (!plane.solve(fit)) continue;
+      qr_plane(x, y, z, k + 1, qr);
+      // Height of the two planes at the edge of the bed
+      double edge = fabs(fit[0] - qr[0]) * DELTA_PROBABLE_RADIUS + fabs(fit[1] - qr[1]) * DELTA_PROBABLE_RADIUS + fabs(fit[2] - qr[2]);
+      if (edge > worst) worst = edge;
+    }
+  }
+  if (!CHECK(worst < 1e-9))
+    printf("  planes %g mm apart at the bed edge\n", worst);
+
+  // Points far from the origin: the means are taken out first, so nothing cancels
+  int n = grid_points(x, y, z, 1000, 0.01);
+  plane.reset();
+  for (int k = 0; k < n; k++) plane.add(x[k], y[k], z[k]);
+  CHECK(plane.solve(fit));
+  qr_plane(x, y, z, n, qr);
+  CHECK_NEAR(fit[0], qr[0], 1e-9);
+  CHECK_NEAR(fit[1], qr[1], 1e-9);
+  CHECK_NEAR(fit[2], qr[2], 1e-6);
+
+  // An exact plane comes back exactly
+  plane.reset();
+  for (int k = 0; k < 9; k++) plane.add(k % 3 * 20 - 20, k / 3 * 20 - 20, 0.001 * (k % 3 * 20 - 20) - 0.002 * (k / 3 * 20 - 20) + 0.3);
+  CHECK(plane.solve(fit));
+  CHECK_NEAR(fit[0], 0.001, 1e-12);
+  CHECK_NEAR(fit[1], -0.002, 1e-12);
+  CHECK_NEAR(fit[2], 0.3, 1e-12);
+
+  // Too few points, or points on a line, do not make a plane
+  plane.reset();
+  CHECK(!plane.solve(fit));
+  plane.add(0, 0, 0);
+  plane.add(10, 0, 0.1);
+  CHECK(!plane.solve(fit));
+  plane.reset();
+  for (int k = 0; k < 5; k++) plane.add(k * 10, k * 5, 0.01 * k);
+  CHECK(!plane.solve(fit));
+  plane.add(0, 30, 0);
+  CHECK(plane.solve(fit));
+
+  return test_done("plane_fit");
+}
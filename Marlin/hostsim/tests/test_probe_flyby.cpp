@@ -0,0 +1,53 @@
+/*
+  test_probe_flyby.cpp - G29 with fly-by probing on the simulated delta:
+  on a flat bed every travel ends in the approach, and a ridge across the
+  travel path is caught on the way, without the rest of the travel
+  dragging the pressed probe over the bed.
+*/
+#include "Marlin.h"
+#include "../hostsim.h"
+#include "test.h"
+
+#define N AUTO_BED_LEVELING_GRID_POINTS
+
+// A ridge higher than PROBE_FLYBY_CLEARANCE across the bed, between two probe columns
+static float ridge(float x, float y)
+{
+  return (x > 15 && x < 22) ? 3 : 0;
+}
+
+// Every bed_level point level with the centre: the bed under the probe points is flat
+static void check_flat()
+{
+  for (int x = 0; x < N; x++)
+    for (int y = 0; y < N; y++)
+      if (!CHECK_NEAR(bed_level[x][y], bed_level[N / 2][N / 2], 0.01))
+        printf("  bed_level[%d][%d]\n", x, y);
+}
+
+int main()
+{
+  hostsim_start();
+  hostsim_gcode("G28\n");
+
+  // Flat: no touch on the way
+  hostsim_output();
+  hostsim_dragged();
+  hostsim_gcode("G29\n");
+  const char *out = hostsim_output();
+  CHECK(!strstr(out, "Fly-by touched early"));
+  CHECK(hostsim_dragged() < 0.01);
+  check_flat();
+
+  // The ridge stops the travels that cross it, and the points either side still read flat
+  hostsim_bed(ridge);
+  hostsim_gcode("G28\nG29\n");
+  out = hostsim_output();
+  CHECK(strstr(out, "Fly-by touched early"));
+  float dragged = hostsim_dragged();
+  if (!CHECK(dragged < 0.5))
+    printf("  dragged %.3f mm\n", dragged);
+  check_flat();
+
+  return test_done("probe_flyby");
+}
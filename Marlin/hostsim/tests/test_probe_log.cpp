@@ -0,0 +1,99 @@
+/*
+  test_probe_log.cpp - the probe log ring: records in the order they were
+  added, the oldest overwritten once PROBE_LOG_SIZE are kept, the M378
+  dump numbering them across the wrap and listing the PROBE_SETTLE_MONITOR
+  wait, and the G29/G30 summary line.
+*/
+#include "Marlin.h"
+#include "probe_log.h"
+#include "../hostsim.h"
+#include "test.h"
+
+// Record k of a run: positions and heights that print exactly
+static float record_x(int k) { return -50 + k * 1.25; }
+static float record_z(int k) { return 0.25 + k * 0.0005; }
+static uint16_t record_settle(int k) { return 20 + k % 7; }
+
+static void add_records(int from, int to)
+{
+  for (int k = from; k < to; k++)
+    probe_log_add(record_x(k), 10, record_z(k), 0.002, 3 + k % 4, millis() - 100 - k, record_settle(k));
+}
+
+// The dump must hold records first..last, oldest first. Returns the number of records listed.
+static int check_dump(int first, int last)
+{
+  hostsim_output();
+  probe_log_dump();
+  const char *out = hostsim_output();
+  if (!CHECK(strncmp(out, "n,ms,x,y,z,sigma,samples,duration,settle\n", 41) == 0)) return 0;
+  int lines = 0;
+  for (const char *line = strchr(out, '\n') + 1; *line; line = strchr(line, '\n') + 1) {
+    unsigned long n, ms, duration, settle;
+    float x, y, z, sigma;
+    int samples;
+    int k = first + lines++;
+    if (!CHECK(sscanf(line, "%lu,%lu,%f,%f,%f,%f,%d,%lu,%lu", &n, &ms, &x, &y, &z, &sigma, &samples, &duration, &settle) == 9))
+      break;
+    bool ok = CHECK(n == (unsigned long)k + 1);
+    ok &= CHECK_NEAR(x, record_x(k), 1e-3);
+    ok &= CHECK_NEAR(y, 10, 1e-3);
+    ok &= CHECK_NEAR(z, record_z(k), 1e-4);
+    ok &= CHECK_NEAR(sigma, 0.002, 1e-4);
+    ok &= CHECK(samples == 3 + k % 4);
+    ok &= CHECK(duration - (100 + k) <= 1); // the clock may tick inside probe_log_add()
+    ok &= CHECK(settle == record_settle(k));
+    if (!ok) printf("  record %d: %.*s\n", k, int(strchr(line, '\n') - line), line);
+  }
+  CHECK(lines == last - first + 1);
+  return lines;
+}
+
+int main()
+{
+  // An empty log dumps just the header
+  probe_log_clear();
+  CHECK(check_dump(0, -1) == 0);
+
+  // A few records, in the order they came
+  probe_log_begin();
+  add_records(0, 5);
+  check_dump(0, 4);
+
+  // Once the ring is full the oldest go first; the numbers carry on across the wrap
+  add_records(5, PROBE_LOG_SIZE + 7);
+  check_dump(7, PROBE_LOG_SIZE + 6);
+  add_records(PROBE_LOG_SIZE + 7, 3 * PROBE_LOG_SIZE);
+  check_dump(2 * PROBE_LOG_SIZE, 3 * PROBE_LOG_SIZE - 1);
+
+  // The summary covers the whole session, not just what the ring still holds
+  hostsim_output();
+  probe_log_summary();
+  const char *out = hostsim_output();
+  char expected[100];
+  sprintf(expected, "Probed %d points in ", 3 * PROBE_LOG_SIZE);
+  CHECK(strncmp(out, expected, strlen(expected)) == 0);
+  sprintf(expected, " ms, z %.3f to %.3f, worst sigma 0.0020 (M378 for the log)\n",
+          record_z(0), record_z(3 * PROBE_LOG_SIZE - 1));
+  if (!CHECK(strstr(out, expected)))
+    printf("  %s", out);
+
+  // A new session starts its own summary; the ring keeps its records
+  probe_log_begin();
+  hostsim_output();
+  probe_log_summary();
+  CHECK(strncmp(hostsim_output(), "Probed 0 points in ", 19) == 0);
+  check_dump(2 * PROBE_LOG_SIZE, 3 * PROBE_LOG_SIZE - 1);
+
+  // Cleared, it numbers from 1 again
+  probe_log_clear();
+  add_records(0, 2);
+  check_dump(0, 1);
+
+  // Sample standard deviation of the taps
+  static const float taps[] = { 0.10, 0.12, 0.11, 0.13 };
+  CHECK_NEAR(probe_log_sigma(taps, 4), 0.0129099, 1e-6);
+  CHECK_NEAR(probe_log_sigma(taps, 1), 0, 1e-9);
+
+  return test_done("probe_log");
+}
@@ -0,0 +1,107 @@
+/*
+  test_probe_sampler.cpp - probe_sampler::add() and update(): early stop on
+  quiet taps, MAD outlier rejection, the PROBE_ADAPTIVE_MAX cap and the
+  Student t value used for each number of accepted taps.
+*/
+#include "Marlin.h"
+#include "probe_sampler.h"
+#include "test.h"
+
+#define STEP (1.0 / 80)  // one Z step, the resolution the sampler is given
+
+// Two-sided 95% t for 1..9 degrees of freedom, to more places than the firmware's table
+static const double t95[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262 };
+
+// n taps around mean whose sample standard deviation is sigma: pairs at +-d and, for odd n,
+// one at the mean. Every tap is the same distance from the median, so none is an outlier.
+static void spread_taps(float *taps, int n, float mean, float sigma)
+{
+  int pairs = n / 2;
+  float d = sigma * sqrt((n - 1) / (2.0 * pairs));
+  for (int i = 0; i < n; i++)
+    taps[i] = i < 2 * pairs ? mean + (i % 2 ? d : -d) : mean;
+}
+
+// Whether the sampler wants no more taps after exactly these
+static bool done_after(const float *taps, int n)
+{
+  probe_sampler sampler;
+  sampler.reset(STEP);
+  bool done = false;
+  for (int i = 0; i < n; i++) done = sampler.add(taps[i]);
+  return done;
+}
+
+int main()
+{
+  probe_sampler sampler;
+
+  // Quiet taps: no decision before PROBE_ADAPTIVE_MIN, then stop at once
+  sampler.reset(STEP);
+  for (int i = 1; i < PROBE_ADAPTIVE_MIN; i++)
+    CHECK(!sampler.add(0.2));
+  CHECK(sampler.add(0.2));
+  CHECK(sampler.count == PROBE_ADAPTIVE_MIN);
+  CHECK(sampler.accepted == PROBE_ADAPTIVE_MIN);
+  CHECK_NEAR(sampler.mean, 0.2, 1e-6);
+  CHECK_NEAR(sampler.sigma, 0, 1e-6);
+
+  // Taps one step apart: a few more taps, then a mean between the two
+  sampler.reset(STEP);
+  float steps[] = { 0.1, 0.1 + STEP, 0.1, 0.1 + STEP, 0.1, 0.1 + STEP, 0.1, 0.1 + STEP };
+  int taps = 0;
+  while (taps < 8 && !sampler.add(steps[taps])) taps++;
+  CHECK(taps > PROBE_ADAPTIVE_MIN - 1 && taps < PROBE_ADAPTIVE_MAX - 1);
+  CHECK_NEAR(sampler.mean, 0.1 + STEP / 2, STEP / 2);
+
+  // An outlier far beyond PROBE_ADAPTIVE_MAD_LIMIT deviations is left out of the mean
+  sampler.reset(STEP);
+  float outlier[] = { 0.1, 0.1 + STEP, 0.1, 0.1 + STEP, 0.6 };
+  for (int i = 0; i < 5; i++) sampler.add(outlier[i]);
+  CHECK(sampler.count == 5);
+  CHECK(sampler.accepted == 4);
+  CHECK_NEAR(sampler.mean, 0.1 + STEP / 2, 1e-6);
+  CHECK_NEAR(sampler.sigma, sqrt(4 * sq(STEP / 2) / 3), 1e-6);
+
+  // ...but with only two taps there is no median to judge by, so both count
+  sampler.reset(STEP);
+  sampler.add(0.1);
+  CHECK(!sampler.add(0.6));
+  CHECK(sampler.accepted == 2);
+  CHECK_NEAR(sampler.mean, 0.35, 1e-6);
+
+  // A tap just inside the limit stays. With every other tap one step from the median the
+  // spread is floored at one step, so the limit is PROBE_ADAPTIVE_MAD_LIMIT steps.
+  sampler.reset(STEP);
+  float inside[] = { 0.1, 0.1 + STEP, 0.1 - STEP, 0.1 + STEP, 0.1 - STEP,
+                     float(0.1 + (PROBE_ADAPTIVE_MAD_LIMIT - 0.2) * STEP) };
+  for (int i = 0; i < 6; i++) sampler.add(inside[i]);
+  CHECK(sampler.accepted == 6);
+
+  // Noise that never settles stops at PROBE_ADAPTIVE_MAX taps
+  static const float noise[] = { -0.04, 0.03, 0, 0.05, -0.02, 0.01, -0.05, 0.04, -0.01, 0.02 };
+  sampler.reset(STEP);
+  int added = 0;
+  bool done = false;
+  while (!done && added < 2 * PROBE_ADAPTIVE_MAX)
+    done = sampler.add(0.1 + noise[added++ % 10]);
+  CHECK(done);
+  CHECK(added == PROBE_ADAPTIVE_MAX);
+  CHECK(sampler.count == PROBE_ADAPTIVE_MAX);
+
+  // Student t: with n accepted taps the interval is t(n - 1 dof) * sigma / sqrt(n). A spread a
+  // little under the tolerance with that t stops, a little over does not; a neighbouring
+  // table entry would get one of the two wrong at every n.
+  for (int n = PROBE_ADAPTIVE_MIN; n < PROBE_ADAPTIVE_MAX; n++) {
+    float t = t95[n - 2];
+    float tap[PROBE_ADAPTIVE_MAX];
+    spread_taps(tap, n, 0.1, 0.97 * PROBE_ADAPTIVE_TOLERANCE * sqrt(n) / t);
+    if (!CHECK(done_after(tap, n)))
+      printf("  %d taps just inside the tolerance did not stop\n", n);
+    spread_taps(tap, n, 0.1, 1.03 * PROBE_ADAPTIVE_TOLERANCE * sqrt(n) / t);
+    if (!CHECK(!done_after(tap, n)))
+      printf("  %d taps just outside the tolerance stopped\n", n);
+  }
+
+  return test_done("probe_sampler");
+}
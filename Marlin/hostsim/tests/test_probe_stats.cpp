@@ -0,0 +1,120 @@
+/*
+  test_probe_stats.cpp - probe_stats, M48's running statistics: the
+  Welford mean and sigma, the histogram bins and the median and mode read
+  from them, and the histogram M48 prints.
+*/
+#include "Marlin.h"
+#include "probe_sampler.h"
+#include "../hostsim.h"
+#include "test.h"
+
+#define BINS M48_HISTOGRAM_BINS
+#define WIDTH M48_HISTOGRAM_BIN_WIDTH
+
+static int compare(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+  return d < 0 ? -1 : d > 0;
+}
+
+int main()
+{
+  probe_stats stats;
+
+  // Mean, population sigma and range against a direct computation
+  static const float taps[] = { 0.512, 0.507, 0.515, 0.509, 0.511, 0.506, 0.514, 0.510 };
+  const int n = sizeof(taps) / sizeof(taps[0]);
+  double sum = 0, sum2 = 0;
+  stats.reset();
+  for (int k = 0; k < n; k++) {
+    stats.add(taps[k]);
+    sum += taps[k];
+  }
+  for (int k = 0; k < n; k++) sum2 += sq(taps[k] - sum / n);
+  CHECK(stats.count == n);
+  CHECK_NEAR(stats.mean, sum / n, 1e-6);
+  CHECK_NEAR(stats.sigma(), sqrt(sum2 / n), 1e-6);
+  CHECK_NEAR(stats.low, 0.506, 1e-6);
+  CHECK_NEAR(stats.high, 0.515, 1e-6);
+
+  // Bins are centred on the first sample; the end bins take everything beyond them
+  stats.reset();
+  stats.add(1.0);                     // middle bin
+  stats.add(1.0 + WIDTH * 1.2);       // one up
+  stats.add(1.0 + WIDTH * 1.4);
+  stats.add(1.0 - WIDTH * 2.1);       // two down
+  stats.add(1.0 + WIDTH * BINS);      // past the top
+  stats.add(1.0 - 1);                 // far below
+  int middle = BINS / 2;
+  CHECK(stats.bins[middle] == 1);
+  CHECK(stats.bins[middle + 1] == 2);
+  CHECK(stats.bins[middle - 2] == 1);
+  CHECK(stats.bins[BINS - 1] == 1);
+  CHECK(stats.bins[0] == 1);
+  unsigned int binned = 0;
+  for (int i = 0; i < BINS; i++) binned += stats.bins[i];
+  CHECK(binned == stats.count);
+  CHECK_NEAR(stats.mode(), 1.0 + WIDTH, 1e-6);
+
+  // The histogram from the first to the last bin used, the fullest with a 40 character bar
+  hostsim_output();
+  stats.report_histogram();
+  const char *out = hostsim_output();
+  int lines = 0;
+  for (const char *c = out; *c; c++) lines += *c == '\n';
+  CHECK(lines == BINS);
+  CHECK(strstr(out, " 2 ########################################\n"));
+  CHECK(strstr(out, " 1 ####################\n"));
+  CHECK(strncmp(out, "0.973 1 ", 8) == 0);  // lower edge of the first bin: 1 - 5.5 bins
+
+  // An empty end of the histogram is not printed
+  stats.reset();
+  stats.add(0.2);
+  stats.add(0.2 + WIDTH);
+  hostsim_output();
+  stats.report_histogram();
+  out = hostsim_output();
+  CHECK(strcmp(out, "0.198 1 ########################################\n"
+                    "0.203 1 ########################################\n") == 0);
+
+  // The median read from the bins is within a bin of the true one
+  static double z[400];
+  for (int set = 0; set < 50; set++) {
+    int count = 5 + set * 7;
+    float centre = 0.3 * noise(), spread = WIDTH * (1 + 2 * (noise() + 1));
+    stats.reset();
+    for (int k = 0; k < count; k++) {
+      // a skewed spread: most taps low, a tail above
+      double u = (noise() + 1) / 2;
+      z[k] = centre + spread * (u * u * 2 - 0.5);
+      stats.add(z[k]);
+    }
+    qsort(z, count, sizeof(z[0]), compare);
+    double median = count % 2 ? z[count / 2] : (z[count / 2 - 1] + z[count / 2]) / 2;
+    if (!CHECK_NEAR(stats.median(), median, WIDTH))
+      printf("  %d taps around %.3f\n", count, centre);
+    CHECK(stats.median() >= stats.low - 1e-6 && stats.median() <= stats.high + WIDTH);
+  }
+
+  // All taps in the middle bin: the median is read at the share of the bin below half of them
+  stats.reset();
+  stats.add(2.0);
+  for (int k = 1; k < 10; k++) stats.add(2.0 - WIDTH / 2 + WIDTH * k / 10);
+  CHECK_NEAR(stats.median(), 2.0, 1e-5);
+  stats.add(2.0 + WIDTH);
+  stats.add(2.0 + WIDTH);
+  CHECK_NEAR(stats.median(), 2.0 + WIDTH / 10, 1e-5);  // half of 12 taps is 6 of the 10 in the bin
+
+  // Many taps in constant RAM, the mean still accurate in float
+  stats.reset();
+  double total = 0;
+  for (long k = 0; k < 100000; k++) {
+    float tap = 5 + 0.01 * noise();
+    stats.add(tap);
+    total += tap;
+  }
+  CHECK_NEAR(stats.mean, total / 100000, 1e-4);  // float's own rounding, 0.1 um
+  CHECK_NEAR(stats.sigma(), 0.01 / sqrt(3), 2e-4);
+
+  return test_done("probe_stats");
+}
@@ -0,0 +1,135 @@
+/*
+  test_refine_bed_level.cpp - the second pass of the adaptive G29:
+  refine_bed_level() fills the blocks between the coarse points that a
+  plane plus bilinear residuals describe, and asks for the others to be
+  probed. The bump and the unreachable corner are placed for the default
+  7 point grid.
+*/
+#include "Marlin.h"
+#include "../hostsim.h"
+#include "test.h"
+
+#define N AUTO_BED_LEVELING_GRID_POINTS
+#define UNPROBED 99.0
+
+static uint8_t order[N * N], points;
+static bool wanted[N * N];
+
+static float grid_x(int x) { return LEFT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_X * x; }
+static float grid_y(int y) { return FRONT_PROBE_BED_POSITION + AUTO_BED_LEVELING_GRID_Y * y; }
+static bool coarse(int x, int y) { return (x - (N - 1) / 2) % 2 == 0 && (y - (N - 1) / 2) % 2 == 0; }
+
+// The points G29 probes on a delta, those within DELTA_PROBABLE_RADIUS, less any given
+static void reachable_points(int skip_x = -1, int skip_y = -1)
+{
+  points = 0;
+  for (int y = 0; y < N; y++)
+    for (int x = 0; x < N; x++)
+      if (sq(grid_x(x)) + sq(grid_y(y)) <= sq(DELTA_PROBABLE_RADIUS) && !(x == skip_x && y == skip_y))
+        order[points++] = x + y * N;
+}
+
+static bool reachable(int x, int y)
+{
+  for (int i = 0; i < points; i++)
+    if (order[i] == x + y * N) return true;
+  return false;
+}
+
+// The coarse pass: the bed's height at the coarse points, nothing elsewhere
+static float plane(int x, int y) { return 0.0004 * grid_x(x) - 0.0003 * grid_y(y) + 0.1; }
+
+static void coarse_pass(float (*residual)(int x, int y))
+{
+  for (int x = 0; x < N; x++)
+    for (int y = 0; y < N; y++)
+      bed_level[x][y] = coarse(x, y) ? plane(x, y) + residual(x, y) : UNPROBED;
+}
+
+static float flat(int, int) { return 0; }
+
+// 1, -2, 1 across the coarse rows and columns: no tilt or offset for the plane fit to take
+// up, 0.016 mm at the centre, inside BED_LEVEL_ADAPTIVE_TOLERANCE
+static float saddle(int x, int y)
+{
+  static const float s[3] = { 1, -2, 1 };
+  return 0.004 * s[(x - 1) / 2] * s[(y - 1) / 2];
+}
+
+// 0.05 mm at the last coarse point: 0.028 mm above the plane fitted through it, while the
+// other coarse points stay within 0.014 mm
+static float bump(int x, int y) { return x == 5 && y == 5 ? 0.05 : 0; }
+
+// Blocks are 2x2 cells between coarse points, named by their lower left corner
+static bool in_block(int x0, int y0, int x, int y)
+{
+  return x >= x0 && x <= x0 + 2 && y >= y0 && y <= y0 + 2;
+}
+
+int main()
+{
+  uint8_t blocks, refined;
+  const int first = ((N - 1) / 2) % 2;
+
+  // A tilted flat bed: every block filled from the plane; only the edge rows left to probe
+  reachable_points();
+  coarse_pass(flat);
+  refined = refine_bed_level(order, points, wanted, &blocks);
+  CHECK(refined == 0);
+  CHECK(blocks == ((N - 1) / 2 - first) * ((N - 1) / 2 - first));
+  for (int x = 0; x < N; x++) {
+    for (int y = 0; y < N; y++) {
+      bool inside = x >= first && x <= N - 1 - first && y >= first && y <= N - 1 - first;
+      if (!CHECK(wanted[x + y * N] == (reachable(x, y) && !coarse(x, y) && !inside)))
+        printf("  point %d,%d\n", x, y);
+      if (inside && !CHECK_NEAR(bed_level[x][y], plane(x, y), 1e-5))
+        printf("  point %d,%d\n", x, y);
+    }
+  }
+
+  // Small residuals: bilinear between each block's corners, on top of the plane
+  coarse_pass(saddle);
+  refined = refine_bed_level(order, points, wanted, &blocks);
+  CHECK(refined == 0);
+  for (int x0 = first; x0 + 2 < N; x0 += 2) {
+    for (int y0 = first; y0 + 2 < N; y0 += 2) {
+      for (int i = 0; i <= 2; i++) {
+        for (int j = 0; j <= 2; j++) {
+          float u = i / 2.0, v = j / 2.0;
+          float r = (1 - u) * (1 - v) * saddle(x0, y0) + u * (1 - v) * saddle(x0 + 2, y0)
+                    + (1 - u) * v * saddle(x0, y0 + 2) + u * v * saddle(x0 + 2, y0 + 2);
+          if (!CHECK_NEAR(bed_level[x0 + i][y0 + j], plane(x0 + i, y0 + j) + r, 1e-5))
+            printf("  block %d,%d point %d,%d\n", x0, y0, i, j);
+        }
+      }
+    }
+  }
+
+  // A bump at one coarse point: its block is probed, the others filled
+  coarse_pass(bump);
+  refined = refine_bed_level(order, points, wanted, &blocks);
+  CHECK(refined == 1);
+  // Every point of the refined block is probed, the edges it shares with filled blocks too
+  for (int x = first; x <= N - 1 - first; x++) {
+    for (int y = first; y <= N - 1 - first; y++) {
+      if (coarse(x, y)) continue;
+      if (!CHECK(wanted[x + y * N] == in_block(3, 3, x, y)))
+        printf("  point %d,%d\n", x, y);
+    }
+  }
+  CHECK(bed_level[4][4] == UNPROBED);
+  CHECK(bed_level[2][2] != UNPROBED && bed_level[2][4] != UNPROBED && bed_level[4][2] != UNPROBED);
+
+  // A coarse corner G29 cannot reach: its blocks work from the corners they have
+  reachable_points(5, 5);
+  coarse_pass(flat);
+  bed_level[5][5] = UNPROBED;
+  refined = refine_bed_level(order, points, wanted, &blocks);
+  CHECK(refined == 0);
+  CHECK(!wanted[5 + 5 * N]);
+  CHECK_NEAR(bed_level[4][4], plane(4, 4), 1e-5);
+  CHECK_NEAR(bed_level[5][4], plane(5, 4), 1e-5);
+  CHECK(bed_level[5][5] == UNPROBED);
+
+  return test_done("refine_bed_level");
+}
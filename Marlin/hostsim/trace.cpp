@@ -0,0 +1,232 @@
+/*
+  trace.cpp - step-stream traces for the host simulation build
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "trace.h"
+
+// What a trace boils down to for comparison: one entry per block.
+struct trace_block {
+  uint64_t ticks;
+  long steps[4];
+  unsigned long events;
+};
+
+struct trace_digest {
+  uint32_t tick_rate;
+  trace_block *blocks;
+  unsigned long count, size;
+  trace_block open;          // steps after the last block marker
+  uint64_t ticks;
+  long steps[4];
+  unsigned long events;
+  double peak_rate[4];       // steps per second
+};
+
+static FILE *out;
+static trace_digest written;
+
+static void digest_reset(trace_digest &d, uint32_t tick_rate)
+{
+  free(d.blocks);
+  memset(&d, 0, sizeof(d));
+  d.tick_rate = tick_rate;
+}
+
+static void digest_add(trace_digest &d, const trace_event &e)
+{
+  d.ticks += e.ticks;
+  d.open.ticks += e.ticks;
+  bool marker = true;
+  for (int i = 0; i < 4; i++) {
+    if (!e.steps[i])
+      continue;
+    marker = false;
+    d.open.steps[i] += e.steps[i];
+    d.steps[i] += labs(e.steps[i]);
+    if (e.ticks) {
+      double rate = labs(e.steps[i]) * (double)d.tick_rate / e.ticks;
+      if (rate > d.peak_rate[i])
+        d.peak_rate[i] = rate;
+    }
+  }
+  if (!marker) {
+    d.open.events++;
+    d.events++;
+    return;
+  }
+  if (d.count == d.size) {
+    d.size = d.size ? d.size * 2 : 256;
+    d.blocks = (trace_block *)realloc(d.blocks, d.size * sizeof(trace_block));
+  }
+  d.blocks[d.count++] = d.open;
+  memset(&d.open, 0, sizeof(d.open));
+}
+
+static bool digest_file(trace_digest &d, const char *path)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "trace: cannot open %s\n", path);
+    return false;
+  }
+  trace_header h;
+  if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != TRACE_MAGIC || h.version != TRACE_VERSION) {
+    fprintf(stderr, "trace: %s is not a version %d step trace\n", path, TRACE_VERSION);
+    fclose(f);
+    return false;
+  }
+  digest_reset(d, h.tick_rate);
+  trace_event e;
+  while (fread(&e, sizeof(e), 1, f) == 1)
+    digest_add(d, e);
+  fclose(f);
+  return true;
+}
+
+static void write_event(const trace_event &e)
+{
+  digest_add(written, e);
+  if (out)
+    fwrite(&e, sizeof(e), 1, out);
+}
+
+bool trace_open(const char *path, uint32_t tick_rate)
+{
+  digest_reset(written, tick_rate);
+  if (!path)
+    return true;
+  out = fopen(path, "wb");
+  if (!out) {
+    fprintf(stderr, "trace: cannot create %s\n", path);
+    return false;
+  }
+  trace_header h = { TRACE_MAGIC, TRACE_VERSION, 4, tick_rate };
+  fwrite(&h, sizeof(h), 1, out);
+  return true;
+}
+
+void trace_step(uint32_t ticks, const long steps[4])
+{
+  trace_event e;
+  e.ticks = ticks;
+  for (int i = 0; i < 4; i++)
+    e.steps[i] = (int8_t)steps[i];
+  write_event(e);
+}
+
+void trace_block_end(uint32_t ticks)
+{
+  trace_event e;
+  memset(&e, 0, sizeof(e));
+  e.ticks = ticks;
+  write_event(e);
+}
+
+void trace_close()
+{
+  if (out)
+    fclose(out);
+  out = NULL;
+}
+
+static void print_summary(const trace_digest &d)
+{
+  static const char axis[4] = { 'X', 'Y', 'Z', 'E' };
+  double tick = 1.0 / d.tick_rate;
+  fprintf(stderr, "trace        %lu step events, %lu blocks, %.3f s of motion\n",
+          d.events, d.count, d.ticks * tick);
+  fprintf(stderr, "             peak step rate");
+  for (int i = 0; i < 4; i++)
+    fprintf(stderr, "  %c %.0f", axis[i], d.peak_rate[i]);
+  fprintf(stderr, " Hz\n");
+  if (!d.count)
+    return;
+  uint64_t low = d.blocks[0].ticks, high = 0, total = 0;
+  for (unsigned long i = 0; i < d.count; i++) {
+    uint64_t t = d.blocks[i].ticks;
+    if (t < low)
+      low = t;
+    if (t > high)
+      high = t;
+    total += t;
+  }
+  fprintf(stderr, "             block duration min %.3f ms, avg %.3f ms, max %.3f ms\n",
+          low * tick * 1000, total * tick * 1000 / d.count, high * tick * 1000);
+}
+
+void trace_summary()
+{
+  print_summary(written);
+}
+
+bool trace_summary_file(const char *path)
+{
+  trace_digest d;
+  memset(&d, 0, sizeof(d));
+  if (!digest_file(d, path))
+    return false;
+  print_summary(d);
+  free(d.blocks);
+  return true;
+}
+
+// A block's duration runs from the previous block's end marker to its
+// own, so it includes any idle time (dwells, heating) before it started.
+bool trace_compare(const char *path, float tolerance, long step_slack)
+{
+  static const char axis[4] = { 'X', 'Y', 'Z', 'E' };
+  trace_digest golden;
+  memset(&golden, 0, sizeof(golden));
+  if (!digest_file(golden, path))
+    return false;
+
+  const trace_digest &run = written;
+  unsigned long differences = 0;
+  #define DIFFER(...) do { if (differences++ < 10) fprintf(stderr, "trace: " __VA_ARGS__); } while (0)
+
+  if (golden.tick_rate != run.tick_rate)
+    DIFFER("tick rate %u, golden %u\n", run.tick_rate, golden.tick_rate);
+  if (golden.count != run.count)
+    DIFFER("%lu blocks, golden %lu\n", run.count, golden.count);
+  // With a slack the per-block differences add up in these totals; the
+  // positions below are checked instead.
+  for (int i = 0; i < 4 && !step_slack; i++) {
+    if (run.steps[i] != golden.steps[i])
+      DIFFER("%ld %c steps, golden %ld\n", run.steps[i], axis[i], golden.steps[i]);
+  }
+  double total = fabs((double)run.ticks - (double)golden.ticks);
+  if (total > golden.ticks * tolerance / 100)
+    DIFFER("%.3f s of motion, golden %.3f s\n",
+           run.ticks / (double)run.tick_rate, golden.ticks / (double)golden.tick_rate);
+
+  unsigned long n = run.count < golden.count ? run.count : golden.count;
+  long run_pos[4] = { 0 }, golden_pos[4] = { 0 };
+  for (unsigned long b = 0; b < n; b++) {
+    const trace_block &r = run.blocks[b], &g = golden.blocks[b];
+    for (int i = 0; i < 4; i++) {
+      if (labs(r.steps[i] - g.steps[i]) > step_slack)
+        DIFFER("block %lu: %ld %c steps, golden %ld\n", b, r.steps[i], axis[i], g.steps[i]);
+      run_pos[i] += r.steps[i];
+      golden_pos[i] += g.steps[i];
+      if (labs(run_pos[i] - golden_pos[i]) > step_slack)
+        DIFFER("block %lu: %c at %ld steps, golden %ld\n", b, axis[i], run_pos[i], golden_pos[i]);
+    }
+    double d = fabs((double)r.ticks - (double)g.ticks);
+    if (d > g.ticks * tolerance / 100 && d > 1)
+      DIFFER("block %lu: %.3f ms, golden %.3f ms\n", b,
+             r.ticks * 1000.0 / run.tick_rate, g.ticks * 1000.0 / golden.tick_rate);
+  }
+  #undef DIFFER
+
+  if (differences > 10)
+    fprintf(stderr, "trace: ... %lu differences in all\n", differences);
+  else if (!differences)
+    fprintf(stderr, "trace: matches %s\n", path);
+  free(golden.blocks);
+  return differences == 0;
+}
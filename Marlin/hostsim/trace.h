@@ -0,0 +1,48 @@
+/*
+  trace.h - step-stream traces for the host simulation build
+
+  A trace is the motion the stepper ISR produced: one event per ISR that
+  issued steps, holding the Timer1 ticks since the previous event and the
+  signed step count per axis, with an all-zero event wherever a block
+  finished.  Traces of a known G-code file are kept as golden files, and
+  a later run compares against them to show that a planner or kinematics
+  change left the motion alone.
+
+  File layout (little-endian): the header, then trace_event records.
+*/
+#ifndef HOSTSIM_TRACE_H
+#define HOSTSIM_TRACE_H
+
+#include <stdint.h>
+
+#define TRACE_MAGIC   0x5054534D  // "MSTP"
+#define TRACE_VERSION 1
+
+struct trace_header {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t axes;
+  uint32_t tick_rate;   // Timer1 ticks per second
+};
+
+struct trace_event {
+  uint32_t ticks;       // since the previous event
+  int8_t steps[4];      // X, Y, Z, E; all zero marks the end of a block
+};
+
+bool trace_open(const char *path, uint32_t tick_rate);
+void trace_step(uint32_t ticks, const long steps[4]);
+void trace_block_end(uint32_t ticks);
+void trace_close();
+
+// Print the summary of the trace just written (or of a file) to stderr.
+void trace_summary();
+bool trace_summary_file(const char *path);
+
+// Compare the trace just written against a golden one.  Block durations
+// may differ by tolerance percent, step totals per block and axis by
+// step_slack, and so may the position of each axis after every block.
+// Returns false, after listing the differences, on a mismatch.
+bool trace_compare(const char *golden, float tolerance, long step_slack);
+
+#endif
@@ -0,0 +1,10 @@
+/*
+  delay.h - busy-wait stand-ins for the host simulation build
+*/
+#ifndef HOSTSIM_UTIL_DELAY_H
+#define HOSTSIM_UTIL_DELAY_H
+
+void _delay_ms(double ms);
+void _delay_us(double us);
+
+#endif
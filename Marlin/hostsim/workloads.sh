@@ -0,0 +1,30 @@
+# Generated G-code workloads shared by bench.sh and kinematics.sh.
+# workloads DIR writes them to DIR as name.gcode.
+
+workloads() {
+  prelude='G28
+M302
+G92 E0
+G1 X0 Y0 Z0.3 F6000'
+
+  # Slicer-style curves: 0.2 mm segments around a 40 mm circle, two laps.
+  {
+    echo "$prelude"
+    awk 'BEGIN { e = 0; for (i = 1; i <= 2514; i++) { a = i * 0.005; e += 0.01;
+      printf "G1 X%.3f Y%.3f E%.4f F3600\n", 40 * cos(a), 40 * sin(a), e } }'
+  } > "$1/tiny-segments.gcode"
+
+  # Long travels across the bed at 200 mm/s.
+  {
+    echo "$prelude"
+    awk 'BEGIN { for (i = 0; i < 60; i++) { a = i * 2.4;
+      printf "G0 X%.3f Y%.3f F12000\n", 100 * cos(a), 100 * sin(a) } }'
+  } > "$1/long-travels.gcode"
+
+  # Long print moves at 50 mm/s, each split into many delta segments.
+  {
+    echo "$prelude"
+    awk 'BEGIN { e = 0; for (i = 0; i < 40; i++) { y = -78 + i * 4; x = (i % 2) ? -60 : 60; e += 4;
+      printf "G1 X%d Y%d E%.2f F3000\n", x, y, e } }'
+  } > "$1/segmented-moves.gcode"
+}
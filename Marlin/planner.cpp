@@ -57,6 +57,9 @@
 #include "temperature.h"
 #include "ultralcd.h"
 #include "language.h"
+#ifdef BUFFER_STATS
+  #include "buffer_stats.h"
+#endif
 
 //===========================================================================
 //=============================public variables ============================
@@ -98,6 +101,22 @@ bool autotemp_enabled=false;
 
 unsigned char g_uc_extruder_last_move[3] = {0,0,0};
 
+#ifdef PLANNER_TIMING
+planner_timer_t planner_timing[PLANNER_TIMERS];
+unsigned long planner_timing_blocks;
+unsigned long planner_timing_junctions;
+
+void planner_timing_add(uint8_t timer, unsigned long started)
+{
+  unsigned long ticks = PLANNER_TIMING_CLOCK() - started;
+  planner_timer_t &t = planner_timing[timer];
+  t.calls++;
+  t.total += ticks;
+  if (ticks > t.max)
+    t.max = ticks;
+}
+#endif // PLANNER_TIMING
+
 //===========================================================================
 //=================semi-private variables, used in inline  functions    =====
 //===========================================================================
@@ -179,6 +198,7 @@ FORCE_INLINE float intersection_distance(float initial_rate, float final_rate, f
 // Calculates trapezoid parameters so that the entry- and exit-speed is compensated by the provided factors.
 
 void calculate_trapezoid_for_block(block_t *block, float entry_factor, float exit_factor) {
+  PLANNER_TIMING_START;
   unsigned long initial_rate = ceil(block->nominal_rate*entry_factor); // (step/min)
   unsigned long final_rate = ceil(block->nominal_rate*exit_factor); // (step/min)
 
@@ -228,6 +248,7 @@ void calculate_trapezoid_for_block(block_t *block, float entry_factor, float exi
 #endif //ADVANCE
   }
   CRITICAL_SECTION_END;
+  PLANNER_TIMING_END(PLANNER_TIMING_TRAPEZOID);
 }                    
 
 // Calculates the maximum allowable speed at this point when you must be able to reach target_velocity using the 
@@ -292,6 +313,7 @@ void planner_reverse_pass() {
       block[1]= block[0];
       block[0] = &block_buffer[block_index];
       planner_reverse_pass_kernel(block[0], block[1], block[2]);
+      PLANNER_TIMING_COUNT(planner_timing_junctions);
     }
   }
 }
@@ -332,6 +354,7 @@ void planner_forward_pass() {
     block[1] = block[2];
     block[2] = &block_buffer[block_index];
     planner_forward_pass_kernel(block[0],block[1],block[2]);
+    PLANNER_TIMING_COUNT(planner_timing_junctions);
     block_index = next_block_index(block_index);
   }
   planner_forward_pass_kernel(block[1], block[2], NULL);
@@ -385,9 +408,11 @@ void planner_recalculate_trapezoids() {
 //   3. Recalculate trapezoids for all blocks.
 
 void planner_recalculate() {   
+  PLANNER_TIMING_START;
   planner_reverse_pass();
   planner_forward_pass();
   planner_recalculate_trapezoids();
+  PLANNER_TIMING_END(PLANNER_TIMING_RECALCULATE);
 }
 
 void plan_init() {
@@ -528,23 +553,35 @@ float junction_deviation = 0.1;
 // Add a new linear movement to the buffer. steps_x, _y and _z is the absolute position in 
 // mm. Microseconds specify how many microseconds the move should take to perform. To aid acceleration
 // calculation the caller must also provide the physical length of the line in millimeters.
-#ifdef ENABLE_AUTO_BED_LEVELING
-void plan_buffer_line(float x, float y, float z, const float &e, float feed_rate, const uint8_t &extruder)
-#else
-void plan_buffer_line(const float &x, const float &y, const float &z, const float &e, float feed_rate, const uint8_t &extruder)
-#endif  //ENABLE_AUTO_BED_LEVELING
-{
-  // Calculate the buffer head after we push this byte
-  int next_buffer_head = next_block_index(block_buffer_head);
+static void plan_buffer_target(long target[4], float feed_rate, const uint8_t &extruder);
 
+static void plan_wait_for_free_block()
+{
   // If the buffer is full: good! That means we are well ahead of the robot. 
   // Rest here until there is room in the buffer.
-  while(block_buffer_tail == next_buffer_head)
+  #ifdef BUFFER_STATS
+    bool full = block_buffer_tail == next_block_index(block_buffer_head);
+    unsigned long started = micros();
+  #endif
+  while(block_buffer_tail == next_block_index(block_buffer_head))
   {
     manage_heater(); 
     manage_inactivity(); 
     lcd_update();
   }
+  #ifdef BUFFER_STATS
+    if (full) buffer_stats_full_wait(micros() - started);
+  #endif
+}
+
+#ifdef ENABLE_AUTO_BED_LEVELING
+void plan_buffer_line(float x, float y, float z, const float &e, float feed_rate, const uint8_t &extruder)
+#else
+void plan_buffer_line(const float &x, const float &y, const float &z, const float &e, float feed_rate, const uint8_t &extruder)
+#endif  //ENABLE_AUTO_BED_LEVELING
+{
+  plan_wait_for_free_block();
+  PLANNER_TIMING_START;
 
 #ifdef ENABLE_AUTO_BED_LEVELING
   apply_rotation_xyz(plan_bed_level_matrix, x, y, z);
@@ -559,6 +596,36 @@ void plan_buffer_line(const float &x, const float &y, const float &z, const floa
   target[Z_AXIS] = lround(z*axis_steps_per_unit[Z_AXIS]);     
   target[E_AXIS] = lround(e*axis_steps_per_unit[E_AXIS]);
 
+  plan_buffer_target(target, feed_rate, extruder);
+  PLANNER_TIMING_END(PLANNER_TIMING_LINE);
+}
+
+#ifdef DELTA_FIXED_POINT_KINEMATICS
+// Same as plan_buffer_line() with the X, Y and Z targets already in absolute steps.
+// The bed level matrix is not applied (Configuration_adv.h rules out plane leveling);
+// deltabots level with bed_level instead.
+void plan_buffer_steps(const long xyz_steps[3], const float &e, float feed_rate, const uint8_t &extruder)
+{
+  plan_wait_for_free_block();
+  PLANNER_TIMING_START;
+
+  long target[4];
+  target[X_AXIS] = xyz_steps[X_AXIS];
+  target[Y_AXIS] = xyz_steps[Y_AXIS];
+  target[Z_AXIS] = xyz_steps[Z_AXIS];
+  target[E_AXIS] = lround(e*axis_steps_per_unit[E_AXIS]);
+
+  plan_buffer_target(target, feed_rate, extruder);
+  PLANNER_TIMING_END(PLANNER_TIMING_LINE);
+}
+#endif // DELTA_FIXED_POINT_KINEMATICS
+
+// Queue a block towards target, in absolute steps. The caller has waited for a free block.
+static void plan_buffer_target(long target[4], float feed_rate, const uint8_t &extruder)
+{
+  // Calculate the buffer head after we push this byte
+  int next_buffer_head = next_block_index(block_buffer_head);
+
   #ifdef PREVENT_DANGEROUS_EXTRUDE
   if(target[E_AXIS]!=position[E_AXIS])
   {
@@ -1012,9 +1079,10 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
 
   // Move buffer head
   block_buffer_head = next_buffer_head;
+  PLANNER_TIMING_COUNT(planner_timing_blocks);
 
   // Update position
-  memcpy(position, target, sizeof(target)); // position[] = target[]
+  memcpy(position, target, sizeof(position)); // position[] = target[]
 
   planner_recalculate();
 
@@ -1075,6 +1143,48 @@ void set_extrude_min_temp(float temp)
 }
 #endif
 
+#ifdef PLANNER_TIMING
+static void planner_timing_line(const char *name, const planner_timer_t &t)
+{
+  serialprintPGM(name);
+  SERIAL_PROTOCOLPGM(": ");
+  SERIAL_PROTOCOL(t.calls);
+  SERIAL_PROTOCOLPGM(" calls, avg ");
+  SERIAL_PROTOCOL_F(t.calls ? (float)t.total / t.calls / PLANNER_TIMING_TICKS_PER_US : 0.0, 1);
+  SERIAL_PROTOCOLPGM(" us, max ");
+  SERIAL_PROTOCOL_F((float)t.max / PLANNER_TIMING_TICKS_PER_US, 1);
+  SERIAL_PROTOCOLLNPGM(" us");
+}
+
+void planner_timing_report()
+{
+  const planner_timer_t &line = planner_timing[PLANNER_TIMING_LINE];
+  float blocks = planner_timing_blocks ? planner_timing_blocks : 1;
+  SERIAL_PROTOCOLPGM("Planner: ");
+  SERIAL_PROTOCOL(planner_timing_blocks);
+  SERIAL_PROTOCOLPGM(" blocks, ");
+  SERIAL_PROTOCOL_F(line.total ? planner_timing_blocks * (1000000.0 * PLANNER_TIMING_TICKS_PER_US) / line.total : 0.0, 0);
+  SERIAL_PROTOCOLPGM(" blocks/s, ");
+  SERIAL_PROTOCOL_F(planner_timing_junctions / blocks, 2);
+  SERIAL_PROTOCOLPGM(" junctions and ");
+  SERIAL_PROTOCOL_F(planner_timing[PLANNER_TIMING_TRAPEZOID].calls / blocks, 2);
+  SERIAL_PROTOCOLLNPGM(" trapezoids per block");
+  planner_timing_line(PSTR("plan_buffer_line"), line);
+  planner_timing_line(PSTR("planner_recalculate"), planner_timing[PLANNER_TIMING_RECALCULATE]);
+  planner_timing_line(PSTR("calculate_trapezoid_for_block"), planner_timing[PLANNER_TIMING_TRAPEZOID]);
+  #ifdef DELTA
+    planner_timing_line(PSTR("delta segment"), planner_timing[PLANNER_TIMING_SEGMENT]);
+  #endif
+}
+
+void planner_timing_clear()
+{
+  memset(planner_timing, 0, sizeof(planner_timing));
+  planner_timing_blocks = 0;
+  planner_timing_junctions = 0;
+}
+#endif // PLANNER_TIMING
+
 // Calculate the steps/s^2 acceleration rates, based on the mm/s^s
 void reset_acceleration_rates()
 {
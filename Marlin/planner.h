@@ -91,6 +91,11 @@ vector_3 plan_get_position();
 void plan_buffer_line(const float &x, const float &y, const float &z, const float &e, float feed_rate, const uint8_t &extruder);
 #endif // ENABLE_AUTO_BED_LEVELING
 
+#ifdef DELTA_FIXED_POINT_KINEMATICS
+// Add a new linear movement with the X, Y and Z targets in absolute steps.
+void plan_buffer_steps(const long xyz_steps[3], const float &e, float feed_rate, const uint8_t &extruder);
+#endif
+
 // Set position. Used for G92 instructions.
 #ifdef ENABLE_AUTO_BED_LEVELING
 void plan_set_position(float x, float y, float z, const float &e);
@@ -159,4 +164,43 @@ void set_extrude_min_temp(float temp);
 #endif
 
 void reset_acceleration_rates();
+
+#ifdef PLANNER_TIMING
+// Clock for the timings and its ticks per microsecond. micros() has a 4 us resolution at
+// 16 MHz; a board with a free-running timer can define a finer cycle counter here.
+#ifndef PLANNER_TIMING_CLOCK
+  #define PLANNER_TIMING_CLOCK() micros()
+  #define PLANNER_TIMING_TICKS_PER_US 1
+#endif
+
+enum { PLANNER_TIMING_LINE, PLANNER_TIMING_RECALCULATE, PLANNER_TIMING_TRAPEZOID, PLANNER_TIMING_SEGMENT, PLANNER_TIMERS };
+
+typedef struct {
+  unsigned long calls;
+  unsigned long total;  // PLANNER_TIMING_CLOCK() ticks
+  unsigned long max;
+} planner_timer_t;
+
+// plan_buffer_line() (after the wait for a free block), planner_recalculate() and
+// calculate_trapezoid_for_block(); each includes the ones it calls. On a delta,
+// prepare_move()'s own work for each segment of a move: the interpolation and the
+// kinematics, plus choosing the number of segments for the first one.
+extern planner_timer_t planner_timing[PLANNER_TIMERS];
+extern unsigned long planner_timing_blocks;     // blocks queued
+extern unsigned long planner_timing_junctions;  // blocks visited by the reverse and forward passes
+
+void planner_timing_add(uint8_t timer, unsigned long started);
+void planner_timing_report();
+void planner_timing_clear();
+
+#define PLANNER_TIMING_START unsigned long timing_started = PLANNER_TIMING_CLOCK()
+#define PLANNER_TIMING_RESTART timing_started = PLANNER_TIMING_CLOCK()
+#define PLANNER_TIMING_END(timer) planner_timing_add(timer, timing_started)
+#define PLANNER_TIMING_COUNT(counter) counter++
+#else
+#define PLANNER_TIMING_START
+#define PLANNER_TIMING_RESTART
+#define PLANNER_TIMING_END(timer)
+#define PLANNER_TIMING_COUNT(counter)
+#endif // PLANNER_TIMING
 #endif
@@ -0,0 +1,118 @@
+/*
+  probe_log.cpp - in-RAM log of bed probe readings
+*/
+#include "Marlin.h"
+#include "probe_log.h"
+#include "temperature.h"
+
+#ifdef PROBE_LOG
+static probe_record probe_log[PROBE_LOG_SIZE];
+static uint8_t probe_log_next = 0;   // where the next record goes
+static unsigned int probe_log_total = 0;  // records added since the last clear
+
+// Session totals for the summary line
+static unsigned int session_points;
+static unsigned long session_start;
+static float session_low, session_high, session_sigma;
+
+void probe_log_begin()
+{
+  session_points = 0;
+  session_start = millis();
+  session_sigma = 0;
+}
+
+void probe_log_add(float x, float y, float z, float sigma, uint8_t samples, unsigned long started, uint16_t settle)
+{
+  probe_record &r = probe_log[probe_log_next];
+  r.time = millis();
+  r.x = x * 100;
+  r.y = y * 100;
+  r.z = z;
+  r.sigma = min(sigma * 1000 + 0.5f, 65535.0f);
+  r.samples = samples;
+  r.duration = min(r.time - started, 65535UL);
+#ifdef PROBE_SETTLE_MONITOR
+  r.settle = settle;
+#endif
+  probe_log_next = (probe_log_next + 1) % PROBE_LOG_SIZE;
+  probe_log_total++;
+
+  if (session_points++ == 0) session_low = session_high = z;
+  session_low = min(session_low, z);
+  session_high = max(session_high, z);
+  session_sigma = max(session_sigma, sigma);
+}
+
+void probe_log_summary()
+{
+  SERIAL_PROTOCOLPGM("Probed ");
+  SERIAL_PROTOCOL(session_points);
+  SERIAL_PROTOCOLPGM(" points in ");
+  SERIAL_PROTOCOL(millis() - session_start);
+  if (session_points) {
+    SERIAL_PROTOCOLPGM(" ms, z ");
+    SERIAL_PROTOCOL_F(session_low, 3);
+    SERIAL_PROTOCOLPGM(" to ");
+    SERIAL_PROTOCOL_F(session_high, 3);
+    SERIAL_PROTOCOLPGM(", worst sigma ");
+    SERIAL_PROTOCOL_F(session_sigma, 4);
+  }
+  else SERIAL_PROTOCOLPGM(" ms");
+  SERIAL_PROTOCOLLNPGM(" (M378 for the log)");
+}
+
+void probe_log_dump()
+{
+  uint8_t count = min(probe_log_total, (unsigned int)PROBE_LOG_SIZE);
+  uint8_t first = (probe_log_next + PROBE_LOG_SIZE - count) % PROBE_LOG_SIZE;
+#ifdef PROBE_SETTLE_MONITOR
+  SERIAL_PROTOCOLLNPGM("n,ms,x,y,z,sigma,samples,duration,settle");
+#else
+  SERIAL_PROTOCOLLNPGM("n,ms,x,y,z,sigma,samples,duration");
+#endif
+  for (uint8_t i = 0; i < count; i++) {
+    const probe_record &r = probe_log[(first + i) % PROBE_LOG_SIZE];
+    SERIAL_PROTOCOL(probe_log_total - count + i + 1);
+    SERIAL_PROTOCOLPGM(",");
+    SERIAL_PROTOCOL(r.time);
+    SERIAL_PROTOCOLPGM(",");
+    SERIAL_PROTOCOL_F(r.x / 100.0, 2);
+    SERIAL_PROTOCOLPGM(",");
+    SERIAL_PROTOCOL_F(r.y / 100.0, 2);
+    SERIAL_PROTOCOLPGM(",");
+    SERIAL_PROTOCOL_F(r.z, 4);
+    SERIAL_PROTOCOLPGM(",");
+    SERIAL_PROTOCOL_F(r.sigma / 1000.0, 4);
+    SERIAL_PROTOCOLPGM(",");
+    SERIAL_PROTOCOL(int(r.samples));
+    SERIAL_PROTOCOLPGM(",");
+#ifdef PROBE_SETTLE_MONITOR
+    SERIAL_PROTOCOL(r.duration);
+    SERIAL_PROTOCOLPGM(",");
+    SERIAL_PROTOCOLLN(r.settle);
+#else
+    SERIAL_PROTOCOLLN(r.duration);
+#endif
+    manage_heater();
+    manage_inactivity();
+  }
+}
+
+void probe_log_clear()
+{
+  probe_log_next = 0;
+  probe_log_total = 0;
+}
+
+float probe_log_sigma(const float samples[], uint8_t n)
+{
+  float mean = 0, m2 = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    float delta = samples[i] - mean;
+    mean += delta / (i + 1);
+    m2 += delta * (samples[i] - mean);
+  }
+  return n > 1 ? sqrt(m2 / (n - 1)) : 0;
+}
+#endif // PROBE_LOG
@@ -0,0 +1,41 @@
+/*
+  probe_log.h - in-RAM log of bed probe readings
+
+  probe_pt() adds one compact record per point instead of printing it, so
+  probing never waits on the serial port. G29 and G30 print a summary line
+  when they finish, and M378 dumps the log as CSV.
+*/
+#ifndef PROBE_LOG_H
+#define PROBE_LOG_H
+
+#include "Marlin.h"
+
+#ifdef PROBE_LOG
+struct probe_record
+{
+  unsigned long time;     // millis() at the reading
+  int16_t x, y;           // 0.01 mm
+  float z;
+  uint16_t sigma;         // um, spread of the samples
+  uint8_t samples;        // taps taken
+  uint16_t duration;      // ms from the start of the travel to the reading
+#ifdef PROBE_SETTLE_MONITOR
+  uint16_t settle;        // ms, longest wait for the probe to release between taps
+#endif
+};
+
+// Start a G29/G30 session for probe_log_summary()
+void probe_log_begin();
+// settle is only kept with PROBE_SETTLE_MONITOR
+void probe_log_add(float x, float y, float z, float sigma, uint8_t samples, unsigned long started, uint16_t settle);
+// Points, height range, worst sigma and time of the session
+void probe_log_summary();
+// CSV of the records still in the ring, oldest first
+void probe_log_dump();
+void probe_log_clear();
+
+// Standard deviation of n samples
+float probe_log_sigma(const float samples[], uint8_t n);
+#endif // PROBE_LOG
+
+#endif // PROBE_LOG_H
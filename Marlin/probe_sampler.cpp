@@ -0,0 +1,141 @@
+/*
+  probe_sampler.cpp - adaptive sampling for bed probe readings
+*/
+#include "Marlin.h"
+#include "probe_sampler.h"
+
+#ifdef PROBE_ADAPTIVE
+
+// Two-sided 95% Student t values for 1..9 degrees of freedom; 1.96 is used above that.
+static const float student_t95[] = { 12.71, 4.30, 3.18, 2.78, 2.57, 2.45, 2.36, 2.31, 2.26 };
+
+// Median of n values, reordering them
+static float median(float *v, uint8_t n)
+{
+  for (uint8_t i = 1; i < n; i++) {
+    float x = v[i];
+    int8_t j = i - 1;
+    for (; j >= 0 && v[j] > x; j--) v[j + 1] = v[j];
+    v[j + 1] = x;
+  }
+  return (n & 1) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+void probe_sampler::reset(float resolution_)
+{
+  count = accepted = 0;
+  mean = sigma = 0;
+  resolution = resolution_;
+}
+
+// Recompute the accepted mean and sigma: drop outliers by MAD, then
+// Welford over what is left.
+void probe_sampler::update()
+{
+  float scratch[PROBE_ADAPTIVE_MAX];
+  memcpy(scratch, samples, count * sizeof(float));
+  float mid = median(scratch, count);
+  for (uint8_t i = 0; i < count; i++) scratch[i] = fabs(samples[i] - mid);
+  // 1.4826 * MAD estimates sigma for normal noise; readings are quantised to
+  // whole steps, so never let it fall below one step.
+  float spread = 1.4826 * median(scratch, count);
+  float limit = PROBE_ADAPTIVE_MAD_LIMIT * max(spread, resolution);
+
+  float m2 = 0;
+  accepted = 0;
+  mean = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (count >= 3 && fabs(samples[i] - mid) > limit) continue;
+    accepted++;
+    float delta = samples[i] - mean;
+    mean += delta / accepted;
+    m2 += delta * (samples[i] - mean);
+  }
+  sigma = accepted > 1 ? sqrt(m2 / (accepted - 1)) : 0;
+}
+
+bool probe_sampler::add(float z)
+{
+  samples[count++] = z;
+  update();
+  if (count >= PROBE_ADAPTIVE_MAX) return true;
+  if (accepted < PROBE_ADAPTIVE_MIN) return false;
+  float t = accepted - 1 <= 9 ? student_t95[accepted - 2] : 1.96;
+  return t * sigma / sqrt(accepted) <= PROBE_ADAPTIVE_TOLERANCE;
+}
+#endif // PROBE_ADAPTIVE
+
+#ifdef Z_PROBE_REPEATABILITY_TEST
+void probe_stats::reset()
+{
+  count = 0;
+  mean = m2 = 0;
+  for (uint8_t i = 0; i < M48_HISTOGRAM_BINS; i++) bins[i] = 0;
+}
+
+void probe_stats::add(float z)
+{
+  if (count == 0) {
+    low = high = z;
+    origin = z - M48_HISTOGRAM_BINS * M48_HISTOGRAM_BIN_WIDTH / 2;
+  }
+  count++;
+  float delta = z - mean;
+  mean += delta / count;
+  m2 += delta * (z - mean);
+  low = min(low, z);
+  high = max(high, z);
+
+  int bin = floor((z - origin) / M48_HISTOGRAM_BIN_WIDTH);
+  bins[constrain(bin, 0, M48_HISTOGRAM_BINS - 1)]++;
+}
+
+float probe_stats::sigma()
+{
+  return count ? sqrt(m2 / count) : 0;
+}
+
+float probe_stats::bin_low(uint8_t i)
+{
+  return origin + i * M48_HISTOGRAM_BIN_WIDTH;
+}
+
+float probe_stats::median()
+{
+  float half = count / 2.0, below = 0;
+  for (uint8_t i = 0; i < M48_HISTOGRAM_BINS; i++) {
+    if (bins[i] && below + bins[i] >= half)
+      return bin_low(i) + M48_HISTOGRAM_BIN_WIDTH * (half - below) / bins[i];
+    below += bins[i];
+  }
+  return mean;
+}
+
+float probe_stats::mode()
+{
+  uint8_t fullest = 0;
+  for (uint8_t i = 1; i < M48_HISTOGRAM_BINS; i++)
+    if (bins[i] > bins[fullest]) fullest = i;
+  return bin_low(fullest) + M48_HISTOGRAM_BIN_WIDTH / 2;
+}
+
+// One line per bin from the first to the last one used: lower edge, count and a bar.
+// The end bins also count the samples beyond them.
+void probe_stats::report_histogram()
+{
+  uint8_t first = 0, last = M48_HISTOGRAM_BINS - 1;
+  unsigned int fullest = 1;
+  while (first < last && !bins[first]) first++;
+  while (last > first && !bins[last]) last--;
+  for (uint8_t i = first; i <= last; i++) fullest = max(fullest, bins[i]);
+
+  for (uint8_t i = first; i <= last; i++) {
+    SERIAL_PROTOCOL_F(bin_low(i), 3);
+    SERIAL_PROTOCOLPGM(" ");
+    SERIAL_PROTOCOL(bins[i]);
+    SERIAL_PROTOCOLPGM(" ");
+    for (uint8_t j = (unsigned long)bins[i] * 40 / fullest; j > 0; j--) SERIAL_PROTOCOLPGM("#");
+    SERIAL_PROTOCOLPGM("\n");
+  }
+}
+#endif // Z_PROBE_REPEATABILITY_TEST
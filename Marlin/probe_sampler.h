@@ -0,0 +1,58 @@
+/*
+  probe_sampler.h - adaptive sampling for bed probe readings
+
+  Taps are added one at a time. Once enough of them agree, the mean is taken
+  as the bed height. Taps further than PROBE_ADAPTIVE_MAD_LIMIT median
+  absolute deviations from the median are left out, and sampling stops when
+  the 95% confidence interval of the mean is within PROBE_ADAPTIVE_TOLERANCE.
+
+  probe_stats keeps running statistics for M48 so that any number of samples
+  fits in constant RAM.
+*/
+#ifndef PROBE_SAMPLER_H
+#define PROBE_SAMPLER_H
+
+#include "Marlin.h"
+
+#ifdef PROBE_ADAPTIVE
+struct probe_sampler
+{
+  float samples[PROBE_ADAPTIVE_MAX];
+  uint8_t count;     // taps taken
+  uint8_t accepted;  // taps that passed the outlier test
+  float mean, sigma; // of the accepted taps
+
+  // resolution is the smallest height step the probe can report (one Z step)
+  void reset(float resolution);
+  // Add a tap. Returns true when no more taps are needed.
+  bool add(float z);
+
+private:
+  float resolution;
+  void update();
+};
+#endif // PROBE_ADAPTIVE
+
+#ifdef Z_PROBE_REPEATABILITY_TEST
+struct probe_stats
+{
+  unsigned int count;
+  float mean;                             // Welford running mean
+  float low, high;
+  unsigned int bins[M48_HISTOGRAM_BINS];  // centred on the first sample, the end bins also
+                                          // count everything beyond them
+
+  void reset();
+  void add(float z);
+  float sigma();   // population standard deviation, as M48 has always reported
+  float median();  // estimated from the histogram
+  float mode();    // centre of the fullest bin
+  void report_histogram();
+
+private:
+  float m2, origin;
+  float bin_low(uint8_t i);
+};
+#endif // Z_PROBE_REPEATABILITY_TEST
+
+#endif // PROBE_SAMPLER_H
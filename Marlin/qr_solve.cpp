@@ -1927,4 +1927,43 @@ double *qr_solve ( int m, int n, double a[], double b[] )
 }
 /******************************************************************************/
 
+void plane_fit::reset()
+{
+  n = 0;
+  mean_x = mean_y = mean_z = 0;
+  cxx = cxy = cyy = cxz = cyz = 0;
+}
+
+void plane_fit::add ( double x, double y, double z )
+{
+  n++;
+  double dx = x - mean_x;
+  double dy = y - mean_y;
+  double dz = z - mean_z;
+  mean_x += dx / n;
+  mean_y += dy / n;
+  mean_z += dz / n;
+  // co-moments use the old delta times the new one (Welford)
+  cxx += dx * ( x - mean_x );
+  cxy += dx * ( y - mean_y );
+  cyy += dy * ( y - mean_y );
+  cxz += dx * ( z - mean_z );
+  cyz += dy * ( z - mean_z );
+}
+
+//  Fill coefficients with a, b, d. Returns false until the points span a plane.
+bool plane_fit::solve ( double coefficients[3] )
+{
+  double det = cxx * cyy - cxy * cxy;
+  if ( n < 3 || det <= 1e-6 * cxx * cyy )
+  {
+    return false;
+  }
+  coefficients[0] = ( cxz * cyy - cyz * cxy ) / det;
+  coefficients[1] = ( cyz * cxx - cxz * cxy ) / det;
+  coefficients[2] = mean_z - coefficients[0] * mean_x - coefficients[1] * mean_y;
+  return true;
+}
+/******************************************************************************/
+
 #endif
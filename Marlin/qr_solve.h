@@ -19,4 +19,18 @@ void dscal ( int n, double sa, double x[], int incx );
 void dswap ( int n, double x[], int incx, double y[], int incy );
 double *qr_solve ( int m, int n, double a[], double b[] );
 
+// Streaming least squares fit of the plane z = a*x + b*y + d.
+// Each point updates running means and co-moments, so the fit needs no
+// matrix and no heap, and can be solved after any number of points.
+struct plane_fit
+{
+  int n;
+  double mean_x, mean_y, mean_z;
+  double cxx, cxy, cyy, cxz, cyz;
+
+  void reset();
+  void add ( double x, double y, double z );
+  bool solve ( double coefficients[3] );
+};
+
 #endif
@@ -29,6 +29,9 @@
 #include "language.h"
 #include "cardreader.h"
 #include "speed_lookuptable.h"
+#ifdef BUFFER_STATS
+  #include "buffer_stats.h"
+#endif
 #if defined(DIGIPOTSS_PIN) && DIGIPOTSS_PIN > -1
 #include <SPI.h>
 #endif
@@ -88,12 +91,70 @@ static bool check_endstops = true;
 volatile long count_position[NUM_AXIS] = { 0, 0, 0, 0};
 volatile signed char count_direction[NUM_AXIS] = { 1, 1, 1, 1};
 
+#ifdef PROBE_TRIGGER_INTERPOLATION
+// Snapshot taken by the Z_MIN interrupt when an armed probe fires: the step counts, the Timer1
+// count since the last step interrupt and the interval to the next one, and the block's step ratios.
+static volatile bool probe_trigger_armed = false;
+static volatile bool probe_trigger_captured = false;
+static long probe_trigger_counts[3];
+static signed char probe_trigger_dir[3];
+static long probe_trigger_steps[3], probe_trigger_events;
+static unsigned short probe_trigger_tcnt, probe_trigger_ocr;
+static uint8_t probe_trigger_loops;
+#endif
+
+#ifdef PROBE_FLYBY
+// A fly-by travel is queued as one stream with its approach; once the probe touches, nothing
+// queued after the touch may run
+enum { PROBE_STOP_OFF, PROBE_STOP_RELEASE, PROBE_STOP_ARMED, PROBE_STOP_HIT };
+static volatile uint8_t probe_stop_state = PROBE_STOP_OFF;
+static volatile bool probe_stop_dropped;
+static bool old_probe_stop_pressed;
+#endif
+
+#ifdef STEPPER_ISR_TIMING
+// Stepper ISR run time in Timer1 ticks per code path, with a histogram of < 4 us, < 8 us, ... < 256 us
+// and longer, plus the time spent at each step_loops setting.
+enum { ISR_PATH_IDLE, ISR_PATH_LOAD, ISR_PATH_ACCEL, ISR_PATH_CRUISE, ISR_PATH_DECEL, ISR_PATHS };
+#define ISR_TIMING_BUCKETS 8
+#define ISR_TIMING_TICKS_PER_US (F_CPU / 8000000.0)  // Timer1 runs at F_CPU / 8
+typedef struct {
+  unsigned long calls, total;
+  unsigned short min, max;
+  unsigned long histogram[ISR_TIMING_BUCKETS];
+} isr_timing_t;
+static isr_timing_t isr_timing[ISR_PATHS];
+static unsigned long isr_loops_calls[3], isr_loops_total[3];  // step_loops 1, 2, 4
+static unsigned long isr_overruns;       // runs that made the next step interrupt late
+static unsigned long isr_timing_started; // millis() at the last clear
+static uint8_t isr_path;
+#define ISR_TIMING_PATH(path) isr_path = path
+// Acceleration, cruise and deceleration on the run that loaded the block count as the block load
+#define ISR_TIMING_PHASE(path) if (isr_path != ISR_PATH_LOAD) isr_path = path
+#else
+#define ISR_TIMING_PATH(path)
+#define ISR_TIMING_PHASE(path)
+#endif
+
 //===========================================================================
 //=============================functions         ============================
 //===========================================================================
 
 #define CHECK_ENDSTOPS  if(check_endstops)
 
+#ifdef HOSTSIM
+// Host simulation build: flash tables live at full-width addresses, and
+// C versions of the multiply helpers below with the same rounding (the
+// 24x24 one keeps the low partial product the AVR version drops, so it
+// can differ by one in the last bit).
+typedef uintptr_t table_address_t;
+#define MultiU16X8toH16(intRes, charIn1, intIn2) \
+  intRes = (unsigned short)(((unsigned long)(unsigned char)(charIn1) * (unsigned short)(intIn2) + 0x80) >> 8)
+#define MultiU24X24toH16(intRes, longIn1, longIn2) \
+  intRes = (unsigned short)((((uint64_t)((longIn1) & 0xFFFFFF) * ((longIn2) & 0xFFFFFF)) + 0x800000) >> 24)
+#else
+typedef unsigned short table_address_t;
+
 // intRes = intIn1 * intIn2 >> 16
 // uses:
 // r26 to store 0
@@ -163,6 +224,7 @@ asm volatile ( \
 : \
 "r26" , "r27" \
 )
+#endif // HOSTSIM
 
 // Some useful constants
 
@@ -263,14 +325,14 @@ FORCE_INLINE unsigned short calc_timer(unsigned short step_rate) {
   if(step_rate < (F_CPU/500000)) step_rate = (F_CPU/500000);
   step_rate -= (F_CPU/500000); // Correct for minimal speed
   if(step_rate >= (8*256)){ // higher step rate
-    unsigned short table_address = (unsigned short)&speed_lookuptable_fast[(unsigned char)(step_rate>>8)][0];
+    table_address_t table_address = (table_address_t)&speed_lookuptable_fast[(unsigned char)(step_rate>>8)][0];
     unsigned char tmp_step_rate = (step_rate & 0x00ff);
     unsigned short gain = (unsigned short)pgm_read_word_near(table_address+2);
     MultiU16X8toH16(timer, tmp_step_rate, gain);
     timer = (unsigned short)pgm_read_word_near(table_address) - timer;
   }
   else { // lower step rates
-    unsigned short table_address = (unsigned short)&speed_lookuptable_slow[0][0];
+    table_address_t table_address = (table_address_t)&speed_lookuptable_slow[0][0];
     table_address += ((step_rate)>>1) & 0xfffc;
     timer = (unsigned short)pgm_read_word_near(table_address);
     timer -= (((unsigned short)pgm_read_word_near(table_address+2) * (unsigned char)(step_rate & 0x0007))>>3);
@@ -312,13 +374,64 @@ FORCE_INLINE void trapezoid_generator_reset() {
 
 // "The Stepper Driver Interrupt" - This timer interrupt is the workhorse.
 // It pops blocks from the block_buffer and executes them by pulsing the stepper pins appropriately.
+#ifdef STEPPER_ISR_TIMING
+static FORCE_INLINE void stepper_isr();
+
+static FORCE_INLINE void isr_timing_add(unsigned short ticks, uint8_t loops)
+{
+  isr_timing_t &t = isr_timing[isr_path];
+  t.calls++;
+  t.total += ticks;
+  if (ticks < t.min) t.min = ticks;
+  if (ticks > t.max) t.max = ticks;
+  uint8_t bucket = 0;
+  for (unsigned short n = ticks >> 3; n && bucket < ISR_TIMING_BUCKETS - 1; n >>= 1) bucket++;
+  t.histogram[bucket]++;
+  if (isr_path != ISR_PATH_IDLE) {
+    uint8_t i = loops >> 1;
+    if (i > 2) i = 2;
+    isr_loops_calls[i]++;
+    isr_loops_total[i] += ticks;
+  }
+}
+
+// Time each run from TCNT1 at entry to TCNT1 at exit. If the count reached the new OCR1A meanwhile,
+// CTC restarted it and the next interrupt is already pending; if it is past OCR1A, that compare was
+// missed and the next step waits for the count to wrap. Both are overruns.
+ISR(TIMER1_COMPA_vect)
+{
+  unsigned short entry = TCNT1;
+  uint8_t loops = step_loops;
+  isr_path = ISR_PATH_IDLE;
+  stepper_isr();
+  unsigned short leave = TCNT1;
+  unsigned short ticks = leave - entry;
+  if (TIFR1 & (1<<OCF1A)) {
+    ticks = OCR1A + 1 - entry + leave;
+    isr_overruns++;
+  }
+  else if (leave >= OCR1A)
+    isr_overruns++;
+  isr_timing_add(ticks, loops);
+}
+
+static FORCE_INLINE void stepper_isr()
+#else
 ISR(TIMER1_COMPA_vect)
+#endif
 {
   // If there is no current block, attempt to pop one from the buffer
   if (current_block == NULL) {
+    #ifdef PROBE_FLYBY
+      while (probe_stop_state == PROBE_STOP_HIT && blocks_queued()) {
+        plan_discard_current_block();
+        probe_stop_dropped = true;
+      }
+    #endif
     // Anything in the buffer?
     current_block = plan_get_current_block();
     if (current_block != NULL) {
+      ISR_TIMING_PATH(ISR_PATH_LOAD);
       current_block->busy = true;
       trapezoid_generator_reset();
       counter_x = -(current_block->step_event_count >> 1);
@@ -538,6 +651,20 @@ ISR(TIMER1_COMPA_vect)
       }
     #endif //!ADVANCE
 
+    #ifdef PROBE_FLYBY
+      // Whichever way the carriages move, two pressed reads in a row end the block
+      if (probe_stop_state != PROBE_STOP_OFF) {
+        bool pressed = (READ(Z_MIN_PIN) != Z_MIN_ENDSTOP_INVERTING);
+        if (!pressed && probe_stop_state == PROBE_STOP_RELEASE)
+          probe_stop_state = PROBE_STOP_ARMED;
+        else if (pressed && old_probe_stop_pressed && probe_stop_state == PROBE_STOP_ARMED)
+          probe_stop_state = PROBE_STOP_HIT;
+        if (probe_stop_state == PROBE_STOP_HIT)
+          step_events_completed = current_block->step_event_count;
+        old_probe_stop_pressed = pressed;
+      }
+    #endif
+
 
 
     for(int8_t i=0; i < step_loops; i++) { // Take multiple steps per interrupt (For high speed moves)
@@ -695,6 +822,7 @@ ISR(TIMER1_COMPA_vect)
     unsigned short timer;
     unsigned short step_rate;
     if (step_events_completed <= (unsigned long int)current_block->accelerate_until) {
+      ISR_TIMING_PHASE(ISR_PATH_ACCEL);
 
       MultiU24X24toH16(acc_step_rate, acceleration_time, current_block->acceleration_rate);
       acc_step_rate += current_block->initial_rate;
@@ -719,6 +847,7 @@ ISR(TIMER1_COMPA_vect)
       #endif
     }
     else if (step_events_completed > (unsigned long int)current_block->decelerate_after) {
+      ISR_TIMING_PHASE(ISR_PATH_DECEL);
       MultiU24X24toH16(step_rate, deceleration_time, current_block->acceleration_rate);
 
       if(step_rate > acc_step_rate) { // Check step_rate stays positive
@@ -747,6 +876,7 @@ ISR(TIMER1_COMPA_vect)
       #endif //ADVANCE
     }
     else {
+      ISR_TIMING_PHASE(ISR_PATH_CRUISE);
       OCR1A = OCR1A_nominal;
       // ensure we're running at the correct step rate, even if we just came off an acceleration
       step_loops = step_loops_nominal;
@@ -756,6 +886,9 @@ ISR(TIMER1_COMPA_vect)
     if (step_events_completed >= current_block->step_event_count) {
       current_block = NULL;
       plan_discard_current_block();
+      #ifdef BUFFER_STATS
+        buffer_stats_block_done((block_buffer_head - block_buffer_tail) & (BLOCK_BUFFER_SIZE - 1));
+      #endif
     }
   }
 }
@@ -817,6 +950,186 @@ ISR(TIMER1_COMPA_vect)
   }
 #endif // ADVANCE
 
+#ifdef PROBE_TRIGGER_INTERPOLATION
+// Timer1 runs in CTC mode, so TCNT1 is the time since the last step interrupt and OCR1A the time
+// to the next one. Interrupts are off inside the stepper ISR, so this always sees whole step events.
+static void probe_trigger_isr()
+{
+  if (!probe_trigger_armed || current_block == NULL) return;
+  probe_trigger_tcnt = TCNT1;
+  probe_trigger_ocr = OCR1A;
+  probe_trigger_loops = step_loops;
+  for (int8_t i = 0; i < 3; i++) {
+    probe_trigger_counts[i] = count_position[i];
+    probe_trigger_dir[i] = count_direction[i];
+  }
+  probe_trigger_steps[X_AXIS] = current_block->steps_x;
+  probe_trigger_steps[Y_AXIS] = current_block->steps_y;
+  probe_trigger_steps[Z_AXIS] = current_block->steps_z;
+  probe_trigger_events = current_block->step_event_count;
+  probe_trigger_armed = false;
+  probe_trigger_captured = true;
+}
+
+void st_probe_trigger_arm()
+{
+  CRITICAL_SECTION_START;
+  probe_trigger_captured = false;
+  probe_trigger_armed = true;
+  CRITICAL_SECTION_END;
+}
+
+float st_interpolate_steps(unsigned short elapsed, unsigned short interval, uint8_t loops, long axis_steps, long events)
+{
+  if (interval == 0 || events == 0) return 0;
+  float fraction = (float)elapsed / interval;
+  if (fraction > 1) fraction = 1;
+  return fraction * loops * axis_steps / events;
+}
+
+// The endstop check ends the block on the second pressed read, one interrupt after the trigger's,
+// and the interrupt that ends it still takes a step event: at most two interrupts' worth of step
+// events and one more past the trigger, plus a step of Bresenham rounding. A trigger further back
+// was not the touch but an edge before it, such as a bounce just after the lift of a re-tap.
+bool st_probe_trigger_plausible(const float trigger[3], const long stop[3], uint8_t loops)
+{
+  float overshoot = 2 * loops + 2;
+  for (int8_t i = 0; i < 3; i++)
+    if (fabs(trigger[i] - stop[i]) > overshoot) return false;
+  return true;
+}
+
+bool st_probe_trigger_position(float steps[3])
+{
+  long stop[3];
+  CRITICAL_SECTION_START;
+  probe_trigger_armed = false;
+  for (int8_t i = 0; i < 3; i++) stop[i] = count_position[i];
+  CRITICAL_SECTION_END;
+  if (!probe_trigger_captured) return false;
+  for (int8_t i = 0; i < 3; i++) {
+    steps[i] = probe_trigger_counts[i] + probe_trigger_dir[i] *
+      st_interpolate_steps(probe_trigger_tcnt, probe_trigger_ocr, probe_trigger_loops, probe_trigger_steps[i], probe_trigger_events);
+  }
+  // step_loops may have changed since the trigger if the move was still speeding up
+  return st_probe_trigger_plausible(steps, stop, max(probe_trigger_loops, (uint8_t)step_loops));
+}
+#endif // PROBE_TRIGGER_INTERPOLATION
+
+#ifdef PROBE_FLYBY
+void st_probe_stop_arm()
+{
+  CRITICAL_SECTION_START;
+  probe_stop_dropped = false;
+  old_probe_stop_pressed = false;
+  probe_stop_state = PROBE_STOP_RELEASE;  // still on the bed from the last probe
+  CRITICAL_SECTION_END;
+}
+
+bool st_probe_stop_disarm()
+{
+  CRITICAL_SECTION_START;
+  probe_stop_state = PROBE_STOP_OFF;
+  CRITICAL_SECTION_END;
+  return probe_stop_dropped;
+}
+#endif // PROBE_FLYBY
+
+#ifdef STEPPER_ISR_TIMING
+void st_timing_clear()
+{
+  CRITICAL_SECTION_START;
+  memset(isr_timing, 0, sizeof(isr_timing));
+  for (int8_t i = 0; i < ISR_PATHS; i++) isr_timing[i].min = 0xFFFF;
+  memset(isr_loops_calls, 0, sizeof(isr_loops_calls));
+  memset(isr_loops_total, 0, sizeof(isr_loops_total));
+  isr_overruns = 0;
+  isr_timing_started = millis();
+  CRITICAL_SECTION_END;
+}
+
+static void st_timing_us(unsigned long ticks)
+{
+  SERIAL_PROTOCOL_F(ticks / ISR_TIMING_TICKS_PER_US, 1);
+}
+
+void st_timing_report()
+{
+  static const char path_idle[] PROGMEM = "idle";
+  static const char path_load[] PROGMEM = "block load";
+  static const char path_accel[] PROGMEM = "accel";
+  static const char path_cruise[] PROGMEM = "cruise";
+  static const char path_decel[] PROGMEM = "decel";
+  static const char * const path_name[ISR_PATHS] = { path_idle, path_load, path_accel, path_cruise, path_decel };
+
+  // One consistent copy; the ISR keeps running while the report goes out
+  isr_timing_t timing[ISR_PATHS];
+  unsigned long loops_calls[3], loops_total[3], overruns, elapsed;
+  CRITICAL_SECTION_START;
+  memcpy(timing, isr_timing, sizeof(timing));
+  memcpy(loops_calls, isr_loops_calls, sizeof(loops_calls));
+  memcpy(loops_total, isr_loops_total, sizeof(loops_total));
+  overruns = isr_overruns;
+  elapsed = millis() - isr_timing_started;
+  CRITICAL_SECTION_END;
+
+  unsigned long calls = 0, total = 0;
+  for (int8_t i = 0; i < ISR_PATHS; i++) {
+    calls += timing[i].calls;
+    total += timing[i].total;
+  }
+  SERIAL_PROTOCOLPGM("Stepper ISR: ");
+  SERIAL_PROTOCOL(calls);
+  SERIAL_PROTOCOLPGM(" runs in ");
+  SERIAL_PROTOCOL(elapsed);
+  SERIAL_PROTOCOLPGM(" ms, ");
+  SERIAL_PROTOCOL_F(elapsed ? total / ISR_TIMING_TICKS_PER_US / 10.0 / elapsed : 0.0, 1);
+  SERIAL_PROTOCOLPGM("% CPU, ");
+  SERIAL_PROTOCOL(overruns);
+  SERIAL_PROTOCOLLNPGM(" overruns");
+
+  for (int8_t i = 0; i < ISR_PATHS; i++) {
+    const isr_timing_t &t = timing[i];
+    serialprintPGM(path_name[i]);
+    SERIAL_PROTOCOLPGM(": ");
+    SERIAL_PROTOCOL(t.calls);
+    if (t.calls) {
+      SERIAL_PROTOCOLPGM(" runs, min ");
+      st_timing_us(t.min);
+      SERIAL_PROTOCOLPGM(" avg ");
+      st_timing_us(t.total / t.calls);
+      SERIAL_PROTOCOLPGM(" max ");
+      st_timing_us(t.max);
+      SERIAL_PROTOCOLPGM(" us, histogram");
+      for (int8_t b = 0; b < ISR_TIMING_BUCKETS - 1; b++) {
+        SERIAL_PROTOCOLPGM(" <");
+        SERIAL_PROTOCOL(4 << b);
+        SERIAL_PROTOCOLPGM(":");
+        SERIAL_PROTOCOL(t.histogram[b]);
+      }
+      SERIAL_PROTOCOLPGM(" >=");
+      SERIAL_PROTOCOL(4 << (ISR_TIMING_BUCKETS - 2));
+      SERIAL_PROTOCOLPGM(":");
+      SERIAL_PROTOCOL(t.histogram[ISR_TIMING_BUCKETS - 1]);
+    }
+    else SERIAL_PROTOCOLPGM(" runs");
+    SERIAL_PROTOCOLLNPGM("");
+  }
+
+  SERIAL_PROTOCOLPGM("step loops");
+  for (int8_t i = 0; i < 3; i++) {
+    SERIAL_PROTOCOLPGM(" x");
+    SERIAL_PROTOCOL(1 << i);
+    SERIAL_PROTOCOLPGM(": ");
+    SERIAL_PROTOCOL(loops_calls[i]);
+    SERIAL_PROTOCOLPGM(" runs avg ");
+    st_timing_us(loops_calls[i] ? loops_total[i] / loops_calls[i] : 0);
+    SERIAL_PROTOCOLPGM(" us");
+  }
+  SERIAL_PROTOCOLLNPGM("");
+}
+#endif // STEPPER_ISR_TIMING
+
 void st_init()
 {
   digipot_init(); //Initialize Digipot Motor Current
@@ -1016,6 +1329,14 @@ void st_init()
     TIMSK0 |= (1<<OCIE0A);
   #endif //ADVANCE
 
+  #ifdef PROBE_TRIGGER_INTERPOLATION
+    attachInterrupt(PROBE_TRIGGER_INTERRUPT, probe_trigger_isr, Z_MIN_ENDSTOP_INVERTING ? FALLING : RISING);
+  #endif
+
+  #ifdef STEPPER_ISR_TIMING
+    st_timing_clear();
+  #endif
+
   enable_endstops(true); // Start with endstops active. After homing they can be disabled
   sei();
 }
@@ -1024,11 +1345,17 @@ void st_init()
 // Block until all buffered steps are executed
 void st_synchronize()
 {
+  #ifdef BUFFER_STATS
+    buffer_stats_draining = true;  // the planner runs dry on purpose, not an underrun
+  #endif
     while( blocks_queued()) {
     manage_heater();
     manage_inactivity();
     lcd_update();
   }
+  #ifdef BUFFER_STATS
+    buffer_stats_draining = false;
+  #endif
 }
 
 void st_set_position(const long &x, const long &y, const long &z, const long &e)
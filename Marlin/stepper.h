@@ -66,6 +66,32 @@ long st_get_position(uint8_t axis);
 float st_get_position_mm(uint8_t axis);
 #endif  //ENABLE_AUTO_BED_LEVELING
 
+#ifdef PROBE_TRIGGER_INTERPOLATION
+// Catch the next Z probe trigger between steps
+void st_probe_trigger_arm();
+// Fractional steps an axis moved between the last step interrupt and the trigger
+float st_interpolate_steps(unsigned short elapsed, unsigned short interval, uint8_t loops, long axis_steps, long events);
+// Whether a trigger at these steps can have stopped carriages at stop, loops step events per interrupt
+bool st_probe_trigger_plausible(const float trigger[3], const long stop[3], uint8_t loops);
+// Position in steps of the X/Y/Z carriages when the probe fired, false if it did not fire or
+// fired too far from where they stopped (a bounce)
+bool st_probe_trigger_position(float steps[3]);
+#endif
+
+#ifdef PROBE_FLYBY
+// Until disarmed, the first Z probe touch after the probe reads released ends the running block
+// and drops every block queued behind it
+void st_probe_stop_arm();
+// Disarm; true if blocks were dropped, i.e. the probe touched before the last queued move
+bool st_probe_stop_disarm();
+#endif
+
+#ifdef STEPPER_ISR_TIMING
+// Stepper ISR run time per code path (M380)
+void st_timing_report();
+void st_timing_clear();
+#endif
+
 // The stepper subsystem goes to sleep when it runs out of things to execute. Call this
 // to notify the subsystem that it is time to go to work.
 void st_wake_up();
@@ -807,9 +807,15 @@ static void lcd_control_motion_menu()
     MENU_ITEM_EDIT_CALLBACK(long5, MSG_AMAX MSG_Z, &max_acceleration_units_per_sq_second[Z_AXIS], 100, 99000, reset_acceleration_rates);
     MENU_ITEM_EDIT_CALLBACK(long5, MSG_AMAX MSG_E, &max_acceleration_units_per_sq_second[E_AXIS], 100, 99000, reset_acceleration_rates);
     MENU_ITEM_EDIT(float5, MSG_A_RETRACT, &retract_acceleration, 100, 99000);
+#ifdef DELTA_FIXED_POINT_KINEMATICS
+    MENU_ITEM_EDIT_CALLBACK(float52, MSG_XSTEPS, &axis_steps_per_unit[X_AXIS], 5, 9999, calculate_delta_steps_init);
+    MENU_ITEM_EDIT_CALLBACK(float52, MSG_YSTEPS, &axis_steps_per_unit[Y_AXIS], 5, 9999, calculate_delta_steps_init);
+    MENU_ITEM_EDIT_CALLBACK(float51, MSG_ZSTEPS, &axis_steps_per_unit[Z_AXIS], 5, 9999, calculate_delta_steps_init);
+#else
     MENU_ITEM_EDIT(float52, MSG_XSTEPS, &axis_steps_per_unit[X_AXIS], 5, 9999);
     MENU_ITEM_EDIT(float52, MSG_YSTEPS, &axis_steps_per_unit[Y_AXIS], 5, 9999);
     MENU_ITEM_EDIT(float51, MSG_ZSTEPS, &axis_steps_per_unit[Z_AXIS], 5, 9999);
+#endif
     MENU_ITEM_EDIT(float51, MSG_ESTEPS, &axis_steps_per_unit[E_AXIS], 5, 9999);
 #ifdef ABORT_ON_ENDSTOP_HIT_FEATURE_ENABLED
     MENU_ITEM_EDIT(bool, MSG_ENDSTOP_ABORT, &abort_on_endstop_hit);